@@ -3,25 +3,23 @@
 
 #include "Components/SIInteractionComponent.h"
 
+#include "Framework/SIInteractionSubsystem.h"
+#include "GameFramework/PlayerController.h"
 #include "Player/SICharacter.h"
-#include "Widgets/SIInteractionWidget.h"
+#include "Widgets/SIHUD.h"
 
 USIInteractionComponent::USIInteractionComponent()
 {
-	SetComponentTickEnabled(false);
+	PrimaryComponentTick.bCanEverTick = false;
 
 	InteractionTime = 0.f;
 	InteractionDistance = 500.f;
 	InteractableNameText = FText::FromString("Interactable Object");
 	InteractableActionText = FText::FromString("Interact");
 	bAllowMultipleInteractors = true;
-
-	Space = EWidgetSpace::Screen;
-	DrawSize = FIntPoint(600, 100);
-	bDrawAtDesiredSize = true;
+	PromptOffset = FVector(0.f, 0.f, 50.f);
 
 	SetActive(true);
-	SetHiddenInGame(true);
 }
 
 void USIInteractionComponent::SetInteractableNameText(const FText& NewNameText)
@@ -52,6 +50,34 @@ void USIInteractionComponent::Deactivate()
 	Interactors.Empty();
 }
 
+void USIInteractionComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	RefreshHighlightPrimitives();
+
+	if (UWorld* World = GetWorld())
+	{
+		if (USIInteractionSubsystem* InteractionSubsystem = World->GetSubsystem<USIInteractionSubsystem>())
+		{
+			InteractionSubsystem->RegisterInteractable(this);
+		}
+	}
+}
+
+void USIInteractionComponent::OnUnregister()
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (USIInteractionSubsystem* InteractionSubsystem = World->GetSubsystem<USIInteractionSubsystem>())
+		{
+			InteractionSubsystem->UnregisterInteractable(this);
+		}
+	}
+
+	Super::OnUnregister();
+}
+
 bool USIInteractionComponent::CanInteract(ASICharacter* Character) const
 {
 	const bool bPlayerAlreadyInteracting = !bAllowMultipleInteractors && Interactors.Num() >= 1;
@@ -60,13 +86,39 @@ bool USIInteractionComponent::CanInteract(ASICharacter* Character) const
 
 void USIInteractionComponent::RefreshWidget()
 {
-	//Make sure the widget is initialized, and that we are displaying the right values (these may have changed)
-	if (USIInteractionWidget* InteractionWidget = Cast<USIInteractionWidget>(GetUserWidgetObject()))
+	if (GetNetMode() == NM_DedicatedServer || !GetWorld())
 	{
-		InteractionWidget->UpdateInteractionWidget(this);
+		return;
+	}
+
+	//Make sure the prompt is displaying the right values (these may have changed), the HUD ignores this if it shows another interactable
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+
+		if (PC && PC->IsLocalController())
+		{
+			if (ASIHUD* HUD = Cast<ASIHUD>(PC->GetHUD()))
+			{
+				HUD->RefreshInteractionPrompt(this);
+			}
+		}
 	}
 }
 
+ASIHUD* USIInteractionComponent::GetLocalHUD(ASICharacter* Character) const
+{
+	if (Character && Character->IsLocallyControlled())
+	{
+		if (APlayerController* PC = Cast<APlayerController>(Character->GetController()))
+		{
+			return Cast<ASIHUD>(PC->GetHUD());
+		}
+	}
+
+	return nullptr;
+}
+
 void USIInteractionComponent::BeginFocus(ASICharacter* Character)
 {
 	if (!IsActive() || !GetOwner() || !Character)
@@ -76,41 +128,64 @@ void USIInteractionComponent::BeginFocus(ASICharacter* Character)
 
 	OnBeginFocus.Broadcast(Character);
 
-	if (GetNetMode() != NM_DedicatedServer)
+	// Only the player looking at it sees the outline, not a listen server host or anyone else sharing the component
+	if (Character->IsLocallyControlled())
 	{
-		SetHiddenInGame(false);
+		SetHighlighted(true);
 
-		TArray<UActorComponent*> FoundComponents;
-		GetOwner()->GetComponents(UPrimitiveComponent::StaticClass(), FoundComponents);
-
-		for (auto& FoundComponent : FoundComponents)
+		if (ASIHUD* HUD = GetLocalHUD(Character))
 		{
-			if (UPrimitiveComponent* Prim = Cast<UPrimitiveComponent>(FoundComponent))
-			{
-				Prim->SetRenderCustomDepth(true);
-			}
+			HUD->ShowInteractionPrompt(this);
 		}
 	}
-
-	RefreshWidget();
 }
 
 void USIInteractionComponent::EndFocus(ASICharacter* Character)
 {
 	OnEndFocus.Broadcast(Character);
 
-	if (GetNetMode() != NM_DedicatedServer)
+	if (Character && Character->IsLocallyControlled())
+	{
+		SetHighlighted(false);
+
+		if (ASIHUD* HUD = GetLocalHUD(Character))
+		{
+			HUD->HideInteractionPrompt(this);
+		}
+	}
+}
+
+void USIInteractionComponent::SetHighlighted(const bool bNewHighlighted)
+{
+	if (bHighlighted == bNewHighlighted)
+	{
+		return;
+	}
+
+	bHighlighted = bNewHighlighted;
+
+	for (UPrimitiveComponent* Prim : HighlightPrimitives)
 	{
-		SetHiddenInGame(true);
+		if (Prim)
+		{
+			Prim->SetRenderCustomDepth(bHighlighted);
+		}
+	}
+}
+
+void USIInteractionComponent::RefreshHighlightPrimitives()
+{
+	HighlightPrimitives.Reset();
 
-		TArray<UActorComponent*> FoundComponents;
-		GetOwner()->GetComponents(UPrimitiveComponent::StaticClass(), FoundComponents);
+	if (AActor* Owner = GetOwner())
+	{
+		Owner->GetComponents<UPrimitiveComponent>(HighlightPrimitives);
 
-		for (auto& FoundComponent : FoundComponents)
+		if (bHighlighted)
 		{
-			if (UPrimitiveComponent* Prim = Cast<UPrimitiveComponent>(FoundComponent))
+			for (UPrimitiveComponent* Prim : HighlightPrimitives)
 			{
-				Prim->SetRenderCustomDepth(false);
+				Prim->SetRenderCustomDepth(true);
 			}
 		}
 	}
@@ -139,18 +214,21 @@ void USIInteractionComponent::Interact(ASICharacter* Character) const
 	}
 }
 
-float USIInteractionComponent::GetInteractPercentage()
+void USIInteractionComponent::SetInteractProgress(ASICharacter* Character, const float NewProgress)
 {
-	if (Interactors.IsValidIndex(0))
+	// Only the first interactor drives the displayed progress
+	if (Interactors.Num() > 0 && Interactors[0] != Character)
+	{
+		return;
+	}
+
+	if (InteractProgress != NewProgress)
 	{
-		if (ASICharacter* Interactor = Interactors[0])
+		InteractProgress = NewProgress;
+
+		if (ASIHUD* HUD = GetLocalHUD(Character))
 		{
-			if (Interactor && Interactor->IsInteracting())
-			{
-				return 1.f - FMath::Abs(Interactor->GetRemainingInteractTime() / InteractionTime);
-			}
+			HUD->UpdateInteractionPromptProgress(this, InteractProgress);
 		}
 	}
-	
-	return 0.f;
 }
@@ -3,41 +3,128 @@
 
 #include "Components/SIInventoryComponent.h"
 
+#include "Components/SIInventoryViewerContents.h"
 #include "Engine/ActorChannel.h"
+#include "Engine/GameInstance.h"
+#include "Engine/NetConnection.h"
+#include "Framework/SIInventoryJournalSubsystem.h"
+#include "Framework/SIInventoryPersistenceSubsystem.h"
+#include "Framework/SIThumbnailAtlasSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "Items/SIContainerItem.h"
 #include "Items/SIItem.h"
 #include "Net/UnrealNetwork.h"
+#include "Persistence/SIInventorySnapshot.h"
+#include "Player/SICharacter.h"
+#include "TimerManager.h"
+
+bool FSIInventoryChunk::IsEmpty() const
+{
+	for (const USIItem* Cell : Cells)
+	{
+		if (Cell)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FSIInventoryChunkArray::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (Owner)
+	{
+		Owner->RebuildChunkLookup();
+		Owner->OnRep_Items();
+	}
+}
 
 USIInventoryComponent::USIInventoryComponent()
 {
 	SetIsReplicatedByDefault(true);
+
+	ItemChunks.Owner = this;
 }
 
 void USIInventoryComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	Items.SetNum(Rows * Columns);
+	ItemChunks.Owner = this;
+
+	if (!bChunkedStorage)
+	{
+		Items.SetNum(Rows * Columns);
+	}
+
 	OnRep_Items();
+
+	RegisterPersistence();
+}
+
+void USIInventoryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterPersistence();
+
+	if (GetWorld())
+	{
+		GetWorld()->GetTimerManager().ClearTimer(ViewerCheckHandle);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void USIInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(USIInventoryComponent, Items);
+	DOREPLIFETIME_CONDITION(USIInventoryComponent, Items, COND_Custom);
+	DOREPLIFETIME_CONDITION(USIInventoryComponent, ItemChunks, COND_Custom);
+
+	// Components created at runtime, like the inner grid of containers, don't have these set on clients otherwise
+	DOREPLIFETIME_CONDITION(USIInventoryComponent, Rows, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(USIInventoryComponent, Columns, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(USIInventoryComponent, bChunkedStorage, COND_InitialOnly);
 	
 	DOREPLIFETIME(USIInventoryComponent, WeightCapacity);
 }
 
+void USIInventoryComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	// Conditions apply to every connection alike, viewer only inventories send their layout through ViewerContents instead
+	DOREPLIFETIME_ACTIVE_OVERRIDE(USIInventoryComponent, Items, !bReplicateToViewersOnly);
+	DOREPLIFETIME_ACTIVE_OVERRIDE(USIInventoryComponent, ItemChunks, !bReplicateToViewersOnly);
+}
+
 bool USIInventoryComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
 {
 	bool bWroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
+	// The layout and the items themselves only go to the connections that opened the inventory
+	if (bReplicateToViewersOnly)
+	{
+		if (!IsViewer(Channel->Connection))
+		{
+			return bWroteSomething;
+		}
+
+		if (ViewerContents)
+		{
+			bWroteSomething |= Channel->ReplicateSubobject(ViewerContents, *Bunch, *RepFlags);
+		}
+	}
+
 	// Check if the array of items needs to replicate
 	if (Channel->KeyNeedsToReplicate(0, ReplicatedItemsKey))
 	{
-		for (auto& Item : Items)
+		// Every item once, not once per tile it covers
+		for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
 		{
+			USIItem* Item = ItemAnchor.Key;
+
 			if (Item)
 			{
 				if (Channel->KeyNeedsToReplicate(Item->GetUniqueID(), Item->RepKey))
@@ -95,7 +182,7 @@ int32 USIInventoryComponent::ConsumeItem(USIItem* Item, const int32 Quantity)
 		{
 			Item->SetQuantity(Item->GetQuantity() - RemoveQuantity);
 			
-			ClientRefreshInventory();
+			RequestClientRefresh();
 		}
 
 		return RemoveQuantity;
@@ -104,6 +191,168 @@ int32 USIInventoryComponent::ConsumeItem(USIItem* Item, const int32 Quantity)
 	return 0;
 }
 
+USIItem* USIInventoryComponent::SplitStack(USIItem* Item, const int32 SplitQuantity, const FInventoryTile TargetTile)
+{
+	if (!Item || !GetOwner() || !GetOwner()->HasAuthority() || !ItemAnchors.Contains(Item))
+	{
+		return nullptr;
+	}
+
+	if (!Item->IsStackable() || SplitQuantity <= 0 || SplitQuantity >= Item->GetQuantity())
+	{
+		return nullptr;
+	}
+
+	// The original stays where it is, so its tiles are not free for the new one. Try the tile asked for, then the first free
+	// spot in the orientation the item has, then the other one
+	const FIntPoint Dimensions = Item->GetDimensions();
+	const TBitArray<>& Mask = GetFootprintMask(Dimensions, nullptr);
+
+	int32 TopLeftIndex = IsTileValid(TargetTile) && Mask[TileToIndex(TargetTile)] ? TileToIndex(TargetTile) : Mask.Find(true);
+	bool bRotateSplit = false;
+
+	if (TopLeftIndex == INDEX_NONE && Dimensions.X != Dimensions.Y)
+	{
+		TopLeftIndex = GetFootprintMask(FIntPoint(Dimensions.Y, Dimensions.X), nullptr).Find(true);
+		bRotateSplit = true;
+	}
+
+	if (TopLeftIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	BeginBatch();
+
+	Item->SetQuantity(Item->GetQuantity() - SplitQuantity);
+	USIItem* NewStack = AddItem(Item, TopLeftIndex, SplitQuantity, Item->GetRotated() != bRotateSplit);
+
+	EndBatch();
+
+	return NewStack;
+}
+
+int32 USIInventoryComponent::MergeStacks(USIItem* SourceItem, USIItem* TargetItem)
+{
+	if (!SourceItem || !TargetItem || SourceItem == TargetItem || !GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return 0;
+	}
+
+	if (!ItemAnchors.Contains(SourceItem) || !ItemAnchors.Contains(TargetItem))
+	{
+		return 0;
+	}
+
+	if (SourceItem->GetClass() != TargetItem->GetClass() || !TargetItem->IsStackable() || TargetItem->IsStackFull())
+	{
+		return 0;
+	}
+
+	// Both stacks are already in here, the weight doesn't change
+	const int32 MergeAmount = FMath::Min(SIInventory::GetStackRoom(TargetItem->GetQuantity(), TargetItem->GetMaxStackSize()), SourceItem->GetQuantity());
+
+	BeginBatch();
+
+	TargetItem->SetQuantity(TargetItem->GetQuantity() + MergeAmount);
+	ConsumeItem(SourceItem, MergeAmount);
+
+	EndBatch();
+
+	return MergeAmount;
+}
+
+int32 USIInventoryComponent::ConsolidateStacks()
+{
+	if (!GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return 0;
+	}
+
+	// Partial stacks of every class, in grid order so the ones nearer the top left are filled first
+	TMap<UClass*, TArray<TPair<int32, USIItem*>, TInlineAllocator<8>>> PartialStacks;
+
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
+	{
+		USIItem* Item = ItemAnchor.Key;
+
+		if (Item && Item->IsStackable() && !Item->IsStackFull())
+		{
+			PartialStacks.FindOrAdd(Item->GetClass()).Emplace(ItemAnchor.Value, Item);
+		}
+	}
+
+	TArray<USIItem*, TInlineAllocator<16>> EmptiedStacks;
+
+	BeginBatch();
+
+	for (TPair<UClass*, TArray<TPair<int32, USIItem*>, TInlineAllocator<8>>>& ClassStacks : PartialStacks)
+	{
+		TArray<TPair<int32, USIItem*>, TInlineAllocator<8>>& Stacks = ClassStacks.Value;
+
+		if (Stacks.Num() < 2)
+		{
+			continue;
+		}
+
+		Stacks.Sort([](const TPair<int32, USIItem*>& A, const TPair<int32, USIItem*>& B)
+		{
+			return A.Key < B.Key;
+		});
+
+		// Pour the last stack into the first one until they meet
+		int32 First = 0;
+		int32 Last = Stacks.Num() - 1;
+
+		while (First < Last)
+		{
+			USIItem* Target = Stacks[First].Value;
+			USIItem* Source = Stacks[Last].Value;
+
+			const int32 MoveAmount = FMath::Min(SIInventory::GetStackRoom(Target->GetQuantity(), Target->GetMaxStackSize()), Source->GetQuantity());
+
+			Target->SetQuantity(Target->GetQuantity() + MoveAmount);
+			Source->SetQuantity(Source->GetQuantity() - MoveAmount);
+
+			if (Target->IsStackFull())
+			{
+				First++;
+			}
+
+			if (Source->GetQuantity() <= 0)
+			{
+				EmptiedStacks.Add(Source);
+				Last--;
+			}
+		}
+	}
+
+	if (EmptiedStacks.Num() > 0)
+	{
+		TArray<int32, TInlineAllocator<32>> EmptiedIndices;
+
+		ForEachOccupiedTile([&EmptiedStacks, &EmptiedIndices](int32 Index, USIItem* TileItem)
+		{
+			if (EmptiedStacks.Contains(TileItem))
+			{
+				EmptiedIndices.Add(Index);
+			}
+		});
+
+		for (const int32 Index : EmptiedIndices)
+		{
+			SetItemAtIndex(Index, nullptr);
+		}
+
+		ReplicatedItemsKey++;
+		NotifyItemsChanged();
+	}
+
+	EndBatch();
+
+	return EmptiedStacks.Num();
+}
+
 bool USIInventoryComponent::RemoveItem(USIItem* Item)
 {
 	if (GetOwner() && GetOwner()->HasAuthority())
@@ -111,18 +360,47 @@ bool USIInventoryComponent::RemoveItem(USIItem* Item)
 		if (Item)
 		{
 			
-			for (int32 Index = 0; Index < Items.Num(); Index++)
+			TArray<int32, TInlineAllocator<16>> ItemIndices;
+
+			ForEachOccupiedTile([Item, &ItemIndices](int32 Index, USIItem* TileItem)
+			{
+				if (TileItem == Item)
+				{
+					ItemIndices.Add(Index);
+				}
+			});
+
+			if (Journal && ItemIndices.Num() > 0)
 			{
-				if (Items[Index] == Item)
+				int32 AnchorIndex = ItemIndices[0];
+
+				for (const int32 Index : ItemIndices)
 				{
-					Items[Index] = nullptr;
+					AnchorIndex = FMath::Min(AnchorIndex, Index);
 				}
+
+				Journal->RecordRemove(JournalKeyId, AnchorIndex);
 			}
 
-			OnRep_Items();
+			for (const int32 Index : ItemIndices)
+			{
+				SetItemAtIndex(Index, nullptr);
+			}
+
+			if (USIContainerItem* Container = Cast<USIContainerItem>(Item))
+			{
+				RemovedContainers.AddUnique(Container);
+			}
+
+			NotifyItemsChanged();
 
 			ReplicatedItemsKey++;
 
+			if (BatchDepth == 0)
+			{
+				ReleaseRemovedContainers();
+			}
+
 			return true;
 		}
 	}
@@ -150,11 +428,11 @@ USIItem* USIInventoryComponent::FindItem(USIItem* Item) const
 {
 	if (Item)
 	{
-		for (auto& InvItem : Items)
+		for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
 		{
-			if (InvItem && InvItem->GetClass() == Item->GetClass())
+			if (ItemAnchor.Key && ItemAnchor.Key->GetClass() == Item->GetClass())
 			{
-				return InvItem;
+				return ItemAnchor.Key;
 			}
 		}
 	}
@@ -166,11 +444,11 @@ TArray<USIItem*> USIInventoryComponent::FindItems(USIItem* Item) const
 {
 	TArray<USIItem*> ItemsOfClass;
 
-	for (auto& InvItem : Items)
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
 	{
-		if (InvItem && InvItem->GetClass() == Item->GetClass() && !ItemsOfClass.Contains(InvItem))
+		if (ItemAnchor.Key && ItemAnchor.Key->GetClass() == Item->GetClass())
 		{
-			ItemsOfClass.Add(InvItem);
+			ItemsOfClass.Add(ItemAnchor.Key);
 		}
 	}
 
@@ -179,11 +457,11 @@ TArray<USIItem*> USIInventoryComponent::FindItems(USIItem* Item) const
 
 USIItem* USIInventoryComponent::FindItemByClass(TSubclassOf<USIItem> ItemClass) const
 {
-	for (auto& InvItem : Items)
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
 	{
-		if (InvItem && InvItem->GetClass() == ItemClass)
+		if (ItemAnchor.Key && ItemAnchor.Key->GetClass() == ItemClass)
 		{
-			return InvItem;
+			return ItemAnchor.Key;
 		}
 	}
 	
@@ -194,11 +472,11 @@ TArray<USIItem*> USIInventoryComponent::FindItemsByClass(TSubclassOf<USIItem> It
 {
 	TArray<USIItem*> ItemsOfClass;
 
-	for (auto& InvItem : Items)
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
 	{
-		if (InvItem && InvItem->GetClass()->IsChildOf(ItemClass) && !ItemsOfClass.Contains(InvItem))
+		if (ItemAnchor.Key && ItemAnchor.Key->GetClass()->IsChildOf(ItemClass))
 		{
-			ItemsOfClass.Add(InvItem);
+			ItemsOfClass.Add(ItemAnchor.Key);
 		}
 	}
 
@@ -207,173 +485,910 @@ TArray<USIItem*> USIInventoryComponent::FindItemsByClass(TSubclassOf<USIItem> It
 
 float USIInventoryComponent::GetCurrentWeight() const
 {
-	float Weight = 0.f;
-
-	for (auto& ItemMap : GetItemsMap())
+	if (bWeightDirty)
 	{
-		if (ItemMap.Key)
+		CachedWeight = 0.f;
+
+		for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
 		{
-			Weight += ItemMap.Key->GetStackWeight();
+			if (ItemAnchor.Key)
+			{
+				CachedWeight += ItemAnchor.Key->GetStackWeight();
+			}
 		}
+
+		bWeightDirty = false;
 	}
 
-	return Weight;
+	return CachedWeight;
 }
 
-TMap<USIItem*, FInventoryTile> USIInventoryComponent::GetItemsMap() const
+float USIInventoryComponent::GetRemainingWeight() const
 {
-	TMap<USIItem*, FInventoryTile> Res;
+	const float RemainingWeight = GetWeightCapacity() - GetCurrentWeight();
 
-	for (int32 Index = 0; Index < Items.Num(); Index++)
+	// Whatever goes in here also weighs on the inventory the container is in
+	if (OwnerContainer && OwnerContainer->OwningInventory && OwnerContainer->OwningInventory != this)
 	{
-		USIItem* Item = Items[Index];
+		return FMath::Min(RemainingWeight, OwnerContainer->OwningInventory->GetRemainingWeight());
+	}
 
-		if (Item)
+	return RemainingWeight;
+}
+
+void USIInventoryComponent::MarkContentsDirty()
+{
+	bWeightDirty = true;
+	ContentsVersion++;
+
+	// Our weight is part of the weight of the container we are the grid of
+	if (OwnerContainer && OwnerContainer->OwningInventory && OwnerContainer->OwningInventory != this)
+	{
+		OwnerContainer->OwningInventory->MarkContentsDirty();
+
+		// The journal records its inventory tile by tile, what changes inside the containers goes in as a snapshot
+		if (OwnerContainer->OwningInventory->Journal)
 		{
-			if (!Res.Contains(Item))
-			{
-				Res.Add(Item, IndexToTile(Index));
-			}
+			OwnerContainer->OwningInventory->Journal->RequestSnapshot(OwnerContainer->OwningInventory);
 		}
 	}
-
-	return Res;
 }
 
-void USIInventoryComponent::ClientRefreshInventory_Implementation()
+const FSIInventoryRoutingSummary& USIInventoryComponent::GetRoutingSummary() const
 {
-	OnInventoryUpdated.Broadcast();
+	if (bRoutingSummaryDirty)
+	{
+		BuildRoutingSummary();
+		bRoutingSummaryDirty = false;
+	}
+
+	return RoutingSummary;
 }
 
-void USIInventoryComponent::OnRep_Items()
+void USIInventoryComponent::BuildRoutingSummary() const
 {
-	OnInventoryUpdated.Broadcast();
+	RoutingSummary.StackRoom.Reset();
 
-	for (auto& Item : Items)
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
 	{
-		// On the client the world won't be set initially, so it set if not
-		if (Item)
+		const USIItem* Item = ItemAnchor.Key;
+
+		if (Item && Item->IsStackable() && !Item->IsStackFull())
 		{
-			if (!Item->World)
-			{
-				OnItemAdded.Broadcast(Item);
-			
-				Item->World = GetWorld();
-			}
+			RoutingSummary.StackRoom.FindOrAdd(Item->GetClass()) += SIInventory::GetStackRoom(Item->GetQuantity(), Item->GetMaxStackSize());
 		}
 	}
+
+	TBitArray<> Occupied;
+	BuildOccupancy(Occupied, nullptr);
+
+	SIInventory::BuildFreeSpace(GetGridShape(), Occupied, RoutingSummary.FreeTiles, RoutingSummary.MaxWidthForHeight);
 }
 
-USIItem* USIInventoryComponent::AddItem(USIItem* Item, const int32 TopLeftIndex, const int32 Quantity)
+int32 USIInventoryComponent::TopUpStacks(USIItem* Item, const int32 Quantity)
 {
-	if (Item && GetOwner() && GetOwner()->HasAuthority())
+	if (!Item || !Item->IsStackable() || Quantity <= 0 || !GetOwner() || !GetOwner()->HasAuthority())
 	{
-		FInventoryTile Tile = IndexToTile(TopLeftIndex);
-		
-		USIItem* NewItem = NewObject<USIItem>(GetOwner(), Item->GetClass());
-		// NewItem->Rename(nullptr, GetOwner());
-		// NewItem->SetOwner(GetOwner());
-		NewItem->SetQuantity(Quantity);
-		NewItem->SetRotated(Item->GetNewRotated());
-		NewItem->OwningInventory = this;
-		
-		FIntPoint Dimensions = NewItem->GetDimensions();
-	
-		for (int32 I = Tile.X; I < Tile.X + Dimensions.X; I++)
+		return 0;
+	}
+
+	int32 Remaining = SIInventory::GetMaxQuantityForWeight(GetRemainingWeight(), Item->GetUnitWeight(), Quantity);
+	int32 Added = 0;
+
+	// Copy the keys, topping up a stack notifies and may touch the anchors
+	TArray<USIItem*, TInlineAllocator<16>> Stacks;
+
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
+	{
+		if (ItemAnchor.Key && ItemAnchor.Key != Item && ItemAnchor.Key->GetClass() == Item->GetClass() && !ItemAnchor.Key->IsStackFull())
 		{
-			for (int32 J = Tile.Y; J < Tile.Y + Dimensions.Y; J++)
-			{
-				int32 TargetIndex = TileToIndex(FInventoryTile(I, J));
+			Stacks.Add(ItemAnchor.Key);
+		}
+	}
 
-				Items[TargetIndex] = NewItem;
-			}
+	for (USIItem* Stack : Stacks)
+	{
+		if (Remaining <= 0)
+		{
+			break;
 		}
-		
-		NewItem->AddedToInventory(this);
-		NewItem->MarkDirtyForReplication();
-		
-		OnRep_Items();
 
-		return NewItem;
+		const int32 AddAmount = FMath::Min(SIInventory::GetStackRoom(Stack->GetQuantity(), Stack->GetMaxStackSize()), Remaining);
+
+		Stack->SetQuantity(Stack->GetQuantity() + AddAmount);
+
+		Remaining -= AddAmount;
+		Added += AddAmount;
 	}
 
-	return nullptr;
+	if (Added > 0)
+	{
+		RequestClientRefresh();
+	}
+
+	return Added;
 }
 
-void USIInventoryComponent::TryMoveItem_Internal(USIItem* Item, const FInventoryTile TargetTile)
+void USIInventoryComponent::InitializeGrid(const int32 InRows, const int32 InColumns, const float InWeightCapacity, const bool bInChunkedStorage/* = false*/)
 {
-	if (Item && GetOwner() && GetOwner()->HasAuthority())
-	{
-		if (Item && IsTileValid(TargetTile))
-		{
-			const int32 TopLeftIndex = TileToIndex(TargetTile);
+	Rows = FMath::Clamp(InRows, 1, MaxGridSize);
+	Columns = FMath::Clamp(InColumns, 1, MaxGridSize);
+	WeightCapacity = InWeightCapacity;
+	bChunkedStorage = bInChunkedStorage;
+}
 
-			if (Items.IsValidIndex(TopLeftIndex))
-			{
-				USIItem* InvItem = Items[TopLeftIndex];
-				
-				// Check if is stackable and has space
-				if (InvItem && InvItem != Item && InvItem->GetClass() == Item->GetClass() && InvItem->bStackable && !InvItem->IsStackFull())
-				{
-					// Somehow the items quantity went over the max stack size. This shouldn't ever happen
-					ensure(Item->GetQuantity() <= Item->MaxStackSize);
-					ensure(InvItem->GetQuantity() <= InvItem->MaxStackSize);
+void USIInventoryComponent::CopyContentsFrom(USIInventoryComponent* Other)
+{
+	if (!Other || Other == this || !GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return;
+	}
 
-					// Find the maximum amount of the item we could take due to weight
-					const int32 WeightMaxAddAmount = FMath::IsNearlyZero(Item->Weight)
-							? Item->GetQuantity()
-							: FMath::FloorToInt((GetWeightCapacity() - GetCurrentWeight()) / Item->Weight);
-					const int32 QuantityMaxAddAmount = FMath::Min(InvItem->MaxStackSize - InvItem->GetQuantity(), Item->GetQuantity());
-					const int32 AddAmount = FMath::Min(WeightMaxAddAmount, QuantityMaxAddAmount);
+	for (const TPair<USIItem*, FInventoryTile>& ItemTile : Other->GetItemsMap())
+	{
+		USIItem* Item = ItemTile.Key;
 
-					if (AddAmount > 0)
-					{
-						InvItem->SetQuantity(InvItem->GetQuantity() + AddAmount);
-							
-						if (AddAmount < Item->GetQuantity())
-						{
-							Item->SetQuantity(Item->GetQuantity() - AddAmount);
-						}
-						else
-						{
-							ConsumeItem(Item, Item->GetQuantity());
-						}
-					}
-				}
-				else if (IsRoomAvailable(Item, TopLeftIndex, false))
-				{
-					ConsumeItem(Item);
-					AddItem(Item, TopLeftIndex, Item->GetQuantity());
-				}
-				else
-				{
-					FSIItemAddResult AddResult = TryAddItem(Item, TargetTile);
-					ConsumeItem(Item, AddResult.AmountGiven);
-				}
-			}
+		if (Item && IsTileValid(ItemTile.Value))
+		{
+			// Place it the way it is lying in the other inventory
+			AddItem(Item, TileToIndex(ItemTile.Value), Item->GetQuantity(), Item->GetRotated());
 		}
 	}
 }
 
-FSIItemAddResult USIInventoryComponent::TryAddItem_Internal(USIItem* Item, const int32 TopLeftIndex)
+bool USIInventoryComponent::CanHoldItem(USIItem* Item) const
 {
-	if (Item && Items.IsValidIndex(TopLeftIndex) && GetOwner() && GetOwner()->HasAuthority())
+	if (!Item)
 	{
-		USIItem* InvItem = Items[TopLeftIndex];
-		
-		// Check if is stackable and has space
-		if (InvItem && InvItem->GetClass() == Item->GetClass() && InvItem->bStackable && !InvItem->IsStackFull())
-		{
+		return false;
+	}
+
+	// Walk up through the containers holding us, an item can't end up inside itself
+	for (const USIInventoryComponent* Inventory = this; Inventory && Inventory->OwnerContainer; Inventory = Inventory->OwnerContainer->OwningInventory)
+	{
+		if (Inventory->OwnerContainer == Item)
+		{
+			return false;
+		}
+
+		if (Item->IsA<USIContainerItem>() && !Inventory->OwnerContainer->bAllowNestedContainers)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void USIInventoryComponent::AddViewer(APlayerController* Viewer)
+{
+	if (Viewer && GetOwner() && GetOwner()->HasAuthority())
+	{
+		Viewers.AddUnique(Viewer);
+
+		if (bReplicateToViewersOnly && !ViewerContents)
+		{
+			ViewerContents = NewObject<USIInventoryViewerContents>(this);
+			ViewerContents->CopyFrom(this);
+		}
+
+		if (!ViewerCheckHandle.IsValid())
+		{
+			GetWorld()->GetTimerManager().SetTimer(ViewerCheckHandle, this, &USIInventoryComponent::CheckViewers, ViewerCheckInterval, true);
+		}
+	}
+}
+
+void USIInventoryComponent::RemoveViewer(APlayerController* Viewer)
+{
+	Viewers.Remove(Viewer);
+
+	if (Viewers.Num() == 0 && GetWorld())
+	{
+		GetWorld()->GetTimerManager().ClearTimer(ViewerCheckHandle);
+	}
+}
+
+void USIInventoryComponent::CheckViewers()
+{
+	Viewers.RemoveAll([this](const APlayerController* Viewer)
+	{
+		// Controllers are destroyed when their player leaves
+		if (!IsValid(Viewer))
+		{
+			return true;
+		}
+
+		const ASICharacter* Character = Cast<ASICharacter>(Viewer->GetPawn());
+
+		return OwnerContainer && (!Character || !Character->CanReachContainer(OwnerContainer));
+	});
+
+	if (Viewers.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(ViewerCheckHandle);
+	}
+}
+
+void USIInventoryComponent::ApplyViewerContents(const TArray<USIItem*>& Cells)
+{
+	for (int32 Index = 0; Index < GetCapacity(); Index++)
+	{
+		SetItemAtIndex(Index, Cells.IsValidIndex(Index) ? Cells[Index] : nullptr);
+	}
+
+	OnRep_Items();
+}
+
+bool USIInventoryComponent::IsViewer(const UNetConnection* Connection) const
+{
+	for (const APlayerController* Viewer : Viewers)
+	{
+		if (Viewer && Connection && Viewer->NetConnection == Connection)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+TMap<USIItem*, FInventoryTile> USIInventoryComponent::GetItemsMap() const
+{
+	TMap<USIItem*, FInventoryTile> Res;
+	Res.Reserve(ItemAnchors.Num());
+
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
+	{
+		Res.Add(ItemAnchor.Key, IndexToTile(ItemAnchor.Value));
+	}
+
+	return Res;
+}
+
+void USIInventoryComponent::PreloadThumbnails()
+{
+	TArray<USIItem*> InventoryItems;
+	GetItemsMap().GetKeys(InventoryItems);
+
+	// Keep the previous request alive until the new one holds the same thumbnails
+	TSharedPtr<FStreamableHandle> PreviousHandle = ThumbnailsHandle;
+	ThumbnailsHandle = USIItem::RequestThumbnails(InventoryItems, FStreamableDelegate::CreateUObject(this, &USIInventoryComponent::OnThumbnailsLoaded));
+
+	if (PreviousHandle.IsValid())
+	{
+		PreviousHandle->ReleaseHandle();
+	}
+}
+
+void USIInventoryComponent::OnThumbnailsLoaded()
+{
+	UGameInstance* GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+
+	if (USIThumbnailAtlasSubsystem* ThumbnailAtlas = GameInstance ? GameInstance->GetSubsystem<USIThumbnailAtlasSubsystem>() : nullptr)
+	{
+		TArray<USIItem*> InventoryItems;
+		GetItemsMap().GetKeys(InventoryItems);
+
+		ThumbnailAtlas->AddThumbnails(InventoryItems);
+	}
+}
+
+FSIInventorySnapshot USIInventoryComponent::CreateSnapshot() const
+{
+	FSIInventorySnapshot Snapshot;
+	Snapshot.Rows = Rows;
+	Snapshot.Columns = Columns;
+	Snapshot.Items.Reserve(ItemAnchors.Num());
+
+	TMap<UClass*, int32, TInlineSetAllocator<16>> TypeIds;
+
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
+	{
+		USIItem* Item = ItemAnchor.Key;
+
+		if (!Item)
+		{
+			continue;
+		}
+
+		int32* TypeId = TypeIds.Find(Item->GetClass());
+
+		if (!TypeId)
+		{
+			TypeId = &TypeIds.Add(Item->GetClass(), Snapshot.ItemTypes.Add(Item->GetClass()->GetPathName()));
+		}
+
+		FSIInventorySnapshotItem& SnapshotItem = Snapshot.Items.AddDefaulted_GetRef();
+		SnapshotItem.TypeId = *TypeId;
+		SnapshotItem.Quantity = Item->GetQuantity();
+		SnapshotItem.Anchor = ItemAnchor.Value;
+		SnapshotItem.bRotated = Item->GetRotated();
+
+		const USIContainerItem* Container = Cast<USIContainerItem>(Item);
+
+		if (Container && Container->GetInnerInventory())
+		{
+			SnapshotItem.InnerInventory = Snapshot.InnerInventories.Add(Container->GetInnerInventory()->CreateSnapshot());
+		}
+	}
+
+	// Grid order keeps the anchor deltas small when written
+	Snapshot.Items.Sort([](const FSIInventorySnapshotItem& A, const FSIInventorySnapshotItem& B)
+	{
+		return A.Anchor < B.Anchor;
+	});
+
+	return Snapshot;
+}
+
+bool USIInventoryComponent::RestoreSnapshot(const FSIInventorySnapshot& Snapshot)
+{
+	if (!GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return false;
+	}
+
+	bool bRestoredAll = Snapshot.Rows <= Rows && Snapshot.Columns <= Columns;
+
+	// Resolve every type once, not once per item
+	TArray<UClass*, TInlineAllocator<16>> ItemClasses;
+
+	for (const FString& ItemType : Snapshot.ItemTypes)
+	{
+		UClass* ItemClass = FSoftClassPath(ItemType).TryLoadClass<USIItem>();
+		ItemClasses.Add(ItemClass);
+
+		bRestoredAll &= ItemClass != nullptr;
+	}
+
+	BeginBatch();
+
+	// Keep what is in here around to be reused, restoring on top of a live inventory then barely creates anything
+	TMap<UClass*, TArray<USIItem*, TInlineAllocator<4>>> ReusableItems;
+
+	for (const TPair<USIItem*, int32>& ItemAnchor : ItemAnchors)
+	{
+		if (ItemAnchor.Key)
+		{
+			ItemAnchor.Key->OwningInventory = nullptr;
+			ReusableItems.FindOrAdd(ItemAnchor.Key->GetClass()).Add(ItemAnchor.Key);
+		}
+	}
+
+	TArray<int32, TInlineAllocator<64>> OccupiedIndices;
+
+	ForEachOccupiedTile([&OccupiedIndices](int32 Index, USIItem* TileItem)
+	{
+		OccupiedIndices.Add(Index);
+	});
+
+	for (const int32 Index : OccupiedIndices)
+	{
+		SetItemAtIndex(Index, nullptr);
+	}
+
+	for (const FSIInventorySnapshotItem& SnapshotItem : Snapshot.Items)
+	{
+		UClass* ItemClass = ItemClasses.IsValidIndex(SnapshotItem.TypeId) ? ItemClasses[SnapshotItem.TypeId] : nullptr;
+
+		if (!ItemClass)
+		{
+			continue;
+		}
+
+		// Snapshots are written in the same grid size, anchors are moved over as tiles in case this one is bigger
+		const FInventoryTile Tile = Snapshot.Columns > 0 ? FInventoryTile(SnapshotItem.Anchor % Snapshot.Columns, SnapshotItem.Anchor / Snapshot.Columns) : FInventoryTile();
+
+		// Items not reused are still created one at a time. Restores into empty inventories come from loads and recovery, once
+		// per inventory, and a pool kept between restores would have to reset whatever state item subclasses add
+		TArray<USIItem*, TInlineAllocator<4>>* Reusable = ReusableItems.Find(ItemClass);
+		const bool bReused = Reusable && Reusable->Num() > 0;
+		USIItem* Item = bReused ? Reusable->Pop(false) : NewObject<USIItem>(GetOwner(), ItemClass);
+
+		Item->SetQuantity(SnapshotItem.Quantity);
+		Item->SetRotated(SnapshotItem.bRotated);
+
+		if (!IsTileValid(Tile) || !IsRoomAvailable(Item, TileToIndex(Tile)))
+		{
+			// Back with the unused ones, so a container left out still has its grid released
+			if (bReused)
+			{
+				Reusable->Add(Item);
+			}
+
+			bRestoredAll = false;
+			continue;
+		}
+
+		const FIntPoint Dimensions = Item->GetDimensions();
+
+		for (int32 Y = Tile.Y; Y < Tile.Y + Dimensions.Y; Y++)
+		{
+			for (int32 X = Tile.X; X < Tile.X + Dimensions.X; X++)
+			{
+				SetItemAtIndex(TileToIndex(FInventoryTile(X, Y)), Item);
+			}
+		}
+
+		Item->OwningInventory = this;
+		Item->AddedToInventory(this);
+		Item->MarkDirtyForReplication();
+
+		// Reused containers keep their grid and have it restored in place, or lose it when the snapshot has no contents
+		if (USIContainerItem* Container = Cast<USIContainerItem>(Item))
+		{
+			if (Snapshot.InnerInventories.IsValidIndex(SnapshotItem.InnerInventory))
+			{
+				if (USIInventoryComponent* InnerInventory = Container->GetOrCreateInnerInventory())
+				{
+					bRestoredAll &= InnerInventory->RestoreSnapshot(Snapshot.InnerInventories[SnapshotItem.InnerInventory]);
+				}
+			}
+			else
+			{
+				Container->DestroyInnerInventory();
+			}
+		}
+	}
+
+	// Containers the snapshot had no use for are gone, their grids are released when the batch ends
+	for (const TPair<UClass*, TArray<USIItem*, TInlineAllocator<4>>>& ClassItems : ReusableItems)
+	{
+		for (USIItem* Item : ClassItems.Value)
+		{
+			if (USIContainerItem* Container = Cast<USIContainerItem>(Item))
+			{
+				RemovedContainers.AddUnique(Container);
+			}
+		}
+	}
+
+	ReplicatedItemsKey++;
+	NotifyItemsChanged();
+
+	EndBatch();
+
+	if (Journal)
+	{
+		Journal->RecordSnapshot(this);
+	}
+
+	return bRestoredAll;
+}
+
+void USIInventoryComponent::SetPersistenceKey(const FString& NewKey)
+{
+	if (PersistenceKey == NewKey)
+	{
+		return;
+	}
+
+	const bool bRegistered = HasBegunPlay();
+
+	if (bRegistered)
+	{
+		UnregisterPersistence();
+	}
+
+	PersistenceKey = NewKey;
+
+	if (bRegistered)
+	{
+		RegisterPersistence();
+	}
+}
+
+void USIInventoryComponent::RegisterPersistence()
+{
+	if (PersistenceKey.IsEmpty() || !GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return;
+	}
+
+	TWeakObjectPtr<USIInventoryComponent> WeakThis = this;
+	const FString Key = PersistenceKey;
+
+	// Journaling starts once the saved contents are in, the empty grid would be journaled over them otherwise
+	TFunction<void(bool)> StartJournal = [WeakThis, Key](bool)
+	{
+		USIInventoryComponent* Inventory = WeakThis.Get();
+
+		if (Inventory && Inventory->HasBegunPlay() && Inventory->PersistenceKey == Key)
+		{
+			if (USIInventoryJournalSubsystem* JournalSubsystem = UGameInstance::GetSubsystem<USIInventoryJournalSubsystem>(Inventory->GetWorld()->GetGameInstance()))
+			{
+				JournalSubsystem->RegisterInventory(Inventory);
+			}
+		}
+	};
+
+	if (USIInventoryPersistenceSubsystem* Persistence = UGameInstance::GetSubsystem<USIInventoryPersistenceSubsystem>(GetWorld()->GetGameInstance()))
+	{
+		Persistence->RegisterInventory(this, MoveTemp(StartJournal));
+	}
+	else
+	{
+		StartJournal(false);
+	}
+}
+
+void USIInventoryComponent::UnregisterPersistence()
+{
+	if (PersistenceKey.IsEmpty() || !GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return;
+	}
+
+	if (USIInventoryPersistenceSubsystem* Persistence = UGameInstance::GetSubsystem<USIInventoryPersistenceSubsystem>(GetWorld()->GetGameInstance()))
+	{
+		Persistence->UnregisterInventory(this);
+	}
+
+	if (USIInventoryJournalSubsystem* JournalSubsystem = UGameInstance::GetSubsystem<USIInventoryJournalSubsystem>(GetWorld()->GetGameInstance()))
+	{
+		JournalSubsystem->UnregisterInventory(this);
+	}
+}
+
+void USIInventoryComponent::BeginBatch()
+{
+	BatchDepth++;
+}
+
+void USIInventoryComponent::EndBatch()
+{
+	if (ensure(BatchDepth > 0) && --BatchDepth == 0)
+	{
+		if (bBatchItemsChanged)
+		{
+			bBatchItemsChanged = false;
+			OnRep_Items();
+		}
+
+		if (bBatchRefreshPending)
+		{
+			bBatchRefreshPending = false;
+			ClientRefreshInventory();
+		}
+
+		ReleaseRemovedContainers();
+	}
+}
+
+void USIInventoryComponent::ReleaseRemovedContainers()
+{
+	TArray<USIContainerItem*> Containers = MoveTemp(RemovedContainers);
+
+	for (USIContainerItem* Container : Containers)
+	{
+		// Containers that moved on took their grid along and dropped ones were renamed into the pickup, the rest are gone
+		if (Container && !Container->OwningInventory && Container->GetTypedOuter<AActor>() == GetOwner())
+		{
+			Container->DestroyInnerInventory();
+		}
+	}
+}
+
+void USIInventoryComponent::NotifyItemsChanged()
+{
+	if (BatchDepth > 0)
+	{
+		bBatchItemsChanged = true;
+	}
+	else
+	{
+		OnRep_Items();
+	}
+}
+
+void USIInventoryComponent::RequestClientRefresh()
+{
+	if (BatchDepth > 0)
+	{
+		bBatchRefreshPending = true;
+	}
+	else
+	{
+		ClientRefreshInventory();
+	}
+}
+
+void USIInventoryComponent::ClientRefreshInventory_Implementation()
+{
+	OnInventoryUpdated.Broadcast();
+}
+
+bool USIInventoryComponent::GetItemTile(USIItem* Item, FInventoryTile& OutTile) const
+{
+	if (const int32* Anchor = ItemAnchors.Find(Item))
+	{
+		OutTile = IndexToTile(*Anchor);
+		return true;
+	}
+
+	return false;
+}
+
+int32 USIInventoryComponent::FindAnchorIndex(const USIItem* Item) const
+{
+	if (const int32* Anchor = ItemAnchors.Find(const_cast<USIItem*>(Item)))
+	{
+		return *Anchor;
+	}
+
+	int32 AnchorIndex = INDEX_NONE;
+
+	ForEachOccupiedTile([Item, &AnchorIndex](int32 Index, USIItem* TileItem)
+	{
+		if (TileItem == Item && (AnchorIndex == INDEX_NONE || Index < AnchorIndex))
+		{
+			AnchorIndex = Index;
+		}
+	});
+
+	return AnchorIndex;
+}
+
+USIItem* USIInventoryComponent::GetItemAtTile(FInventoryTile Tile) const
+{
+	return IsTileValid(Tile) ? GetItemAtIndex(TileToIndex(Tile)) : nullptr;
+}
+
+void USIInventoryComponent::NotifyItemQuantityChanged(USIItem* Item)
+{
+	MarkContentsDirty();
+	bRoutingSummaryDirty = true;
+
+	if (Journal)
+	{
+		Journal->RecordQuantity(JournalKeyId, FindAnchorIndex(Item), Item->GetQuantity());
+	}
+
+	if (const int32* Anchor = ItemAnchors.Find(Item))
+	{
+		OnInventoryItemQuantityChanged.Broadcast(Item, IndexToTile(*Anchor));
+	}
+}
+
+void USIInventoryComponent::NotifyItemRotated(USIItem* Item)
+{
+	MarkContentsDirty();
+
+	if (Journal)
+	{
+		Journal->RecordRotate(JournalKeyId, FindAnchorIndex(Item), Item->GetRotated());
+	}
+
+	if (const int32* Anchor = ItemAnchors.Find(Item))
+	{
+		OnInventoryItemRotated.Broadcast(Item, IndexToTile(*Anchor));
+	}
+}
+
+void USIInventoryComponent::OnRep_Items()
+{
+	if (ViewerContents && GetOwner() && GetOwner()->HasAuthority())
+	{
+		ViewerContents->CopyFrom(this);
+	}
+
+	InventoryVersion++;
+	MarkContentsDirty();
+	bRoutingSummaryDirty = true;
+
+	// Find where every item is anchored now. Indices grow row by row, so the lowest index of an item is its top left tile
+	TMap<USIItem*, int32> NewAnchors;
+	NewAnchors.Reserve(ItemAnchors.Num() + 1);
+
+	ForEachOccupiedTile([&NewAnchors](int32 Index, USIItem* Item)
+	{
+		if (int32* Anchor = NewAnchors.Find(Item))
+		{
+			*Anchor = FMath::Min(*Anchor, Index);
+		}
+		else
+		{
+			NewAnchors.Add(Item, Index);
+		}
+	});
+
+	TArray<TPair<USIItem*, int32>, TInlineAllocator<4>> RemovedItems;
+	TArray<TPair<USIItem*, int32>, TInlineAllocator<4>> AddedItems;
+	TArray<TTuple<USIItem*, int32, int32>, TInlineAllocator<4>> MovedItems;
+
+	for (const TPair<USIItem*, int32>& OldAnchor : ItemAnchors)
+	{
+		if (!NewAnchors.Contains(OldAnchor.Key))
+		{
+			RemovedItems.Add(OldAnchor);
+		}
+	}
+
+	for (const TPair<USIItem*, int32>& NewAnchor : NewAnchors)
+	{
+		if (const int32* OldIndex = ItemAnchors.Find(NewAnchor.Key))
+		{
+			if (*OldIndex != NewAnchor.Value)
+			{
+				MovedItems.Add(MakeTuple(NewAnchor.Key, *OldIndex, NewAnchor.Value));
+			}
+		}
+		else
+		{
+			AddedItems.Add(NewAnchor);
+		}
+	}
+
+	ItemAnchors = MoveTemp(NewAnchors);
+
+	for (const TPair<USIItem*, int32>& Removed : RemovedItems)
+	{
+		if (Removed.Key && Removed.Key->OwningInventory == this)
+		{
+			Removed.Key->OwningInventory = nullptr;
+		}
+
+		OnInventoryItemRemoved.Broadcast(Removed.Key, IndexToTile(Removed.Value));
+	}
+
+	for (const TTuple<USIItem*, int32, int32>& Moved : MovedItems)
+	{
+		OnInventoryItemMoved.Broadcast(Moved.Get<0>(), IndexToTile(Moved.Get<1>()), IndexToTile(Moved.Get<2>()));
+	}
+
+	for (const TPair<USIItem*, int32>& Added : AddedItems)
+	{
+		// Clients don't get the owning inventory replicated, so it is set here
+		Added.Key->OwningInventory = this;
+
+		// On the client the world won't be set initially, so it set if not
+		if (!Added.Key->World)
+		{
+			OnItemAdded.Broadcast(Added.Key);
+
+			Added.Key->World = GetWorld();
+		}
+
+		OnInventoryItemAdded.Broadcast(Added.Key, IndexToTile(Added.Value));
+	}
+
+	OnInventoryUpdated.Broadcast();
+}
+
+USIItem* USIInventoryComponent::AddItem(USIItem* Item, const int32 TopLeftIndex, const int32 Quantity, const bool bPlaceRotated)
+{
+	if (Item && GetOwner() && GetOwner()->HasAuthority())
+	{
+		FInventoryTile Tile = IndexToTile(TopLeftIndex);
+		
+		USIItem* NewItem = NewObject<USIItem>(GetOwner(), Item->GetClass());
+		// NewItem->Rename(nullptr, GetOwner());
+		// NewItem->SetOwner(GetOwner());
+		NewItem->SetQuantity(Quantity);
+		NewItem->SetRotated(bPlaceRotated);
+		NewItem->OwningInventory = this;
+		NewItem->CopyStateFrom(Item);
+		
+		FIntPoint Dimensions = NewItem->GetDimensions();
+	
+		for (int32 I = Tile.X; I < Tile.X + Dimensions.X; I++)
+		{
+			for (int32 J = Tile.Y; J < Tile.Y + Dimensions.Y; J++)
+			{
+				int32 TargetIndex = TileToIndex(FInventoryTile(I, J));
+
+				SetItemAtIndex(TargetIndex, NewItem);
+			}
+		}
+		
+		NewItem->AddedToInventory(this);
+		NewItem->MarkDirtyForReplication();
+
+		if (Journal)
+		{
+			Journal->RecordAdd(JournalKeyId, NewItem->GetClass(), TopLeftIndex, Quantity, NewItem->GetRotated());
+
+			// Containers can come in with contents, which the entry doesn't carry
+			if (NewItem->IsA<USIContainerItem>())
+			{
+				Journal->RequestSnapshot(this);
+			}
+		}
+		
+		NotifyItemsChanged();
+
+		return NewItem;
+	}
+
+	return nullptr;
+}
+
+void USIInventoryComponent::TryMoveItem_Internal(USIItem* Item, const FInventoryTile TargetTile)
+{
+	if (Item && GetOwner() && GetOwner()->HasAuthority())
+	{
+		if (Item && IsTileValid(TargetTile))
+		{
+			const int32 TopLeftIndex = TileToIndex(TargetTile);
+
+			if (IsIndexValid(TopLeftIndex))
+			{
+				USIItem* InvItem = GetItemAtIndex(TopLeftIndex);
+
+				// An item moved within this inventory is already part of its weight
+				const float RemainingWeight = Item->OwningInventory == this ? GetRemainingWeight() + Item->GetStackWeight() : GetRemainingWeight();
+				
+				// Check if is stackable and has space
+				if (InvItem && InvItem != Item && InvItem->GetClass() == Item->GetClass() && InvItem->IsStackable() && !InvItem->IsStackFull())
+				{
+					// Somehow the items quantity went over the max stack size. This shouldn't ever happen
+					ensure(Item->GetQuantity() <= Item->GetMaxStackSize());
+					ensure(InvItem->GetQuantity() <= InvItem->GetMaxStackSize());
+
+					// The room on the stack, as far as the weight left allows
+					const int32 AddAmount = SIInventory::GetStackAddAmount(InvItem->GetQuantity(), InvItem->GetMaxStackSize(), Item->GetQuantity(), RemainingWeight, Item->GetUnitWeight());
+
+					if (AddAmount > 0)
+					{
+						InvItem->SetQuantity(InvItem->GetQuantity() + AddAmount);
+							
+						if (AddAmount < Item->GetQuantity())
+						{
+							Item->SetQuantity(Item->GetQuantity() - AddAmount);
+						}
+						else
+						{
+							ConsumeItem(Item, Item->GetQuantity());
+						}
+					}
+				}
+				else if (IsRoomAvailable(Item, TopLeftIndex, false) && SIInventory::GetMaxQuantityForWeight(RemainingWeight, Item->GetUnitWeight(), Item->GetQuantity()) >= Item->GetQuantity())
+				{
+					// Batched so a container hands its grid over to the copy before it would be released
+					BeginBatch();
+
+					ConsumeItem(Item);
+					AddItem(Item, TopLeftIndex, Item->GetQuantity(), Item->GetNewRotated());
+
+					EndBatch();
+				}
+				else
+				{
+					// What didn't fit is left on the item
+					if (TryAddItem(Item, TargetTile).Result == ESIItemAddResult::IAR_AllItemsAdded)
+					{
+						ConsumeItem(Item);
+					}
+				}
+			}
+		}
+	}
+}
+
+FSIItemAddResult USIInventoryComponent::TryAddItem_Internal(USIItem* Item, const int32 TopLeftIndex)
+{
+	if (Item && !CanHoldItem(Item))
+	{
+		return FSIItemAddResult::AddedNone(Item->GetQuantity(), FText::Format(FText::FromString("{ItemName} can't be put in there."), Item->GetDisplayName()));
+	}
+
+	if (Item && IsIndexValid(TopLeftIndex) && GetOwner() && GetOwner()->HasAuthority())
+	{
+		const int32 Quantity = Item->GetQuantity();
+		const FText FullText = FText::Format(FText::FromString("Couldn't add {ItemName} to Inventory. Inventory is full."), Item->GetDisplayName());
+
+		USIItem* InvItem = GetItemAtIndex(TopLeftIndex);
+		
+		// Check if is stackable and has space
+		if (InvItem && InvItem->GetClass() == Item->GetClass() && InvItem->IsStackable() && !InvItem->IsStackFull())
+		{
 			// Somehow the items quantity went over the max stack size. This shouldn't ever happen
-			ensure(Item->GetQuantity() <= Item->MaxStackSize);
-			ensure(InvItem->GetQuantity() <= InvItem->MaxStackSize);
+			ensure(Item->GetQuantity() <= Item->GetMaxStackSize());
+			ensure(InvItem->GetQuantity() <= InvItem->GetMaxStackSize());
 
-			// Find the maximum amount of the item we could take due to weight
-			const int32 WeightMaxAddAmount = FMath::IsNearlyZero(Item->Weight)
-				? Item->GetQuantity()
-				: FMath::FloorToInt((GetWeightCapacity() - GetCurrentWeight()) / Item->Weight);
-			const int32 QuantityMaxAddAmount = FMath::Min(InvItem->MaxStackSize - InvItem->GetQuantity(), Item->GetQuantity());
-			const int32 AddAmount = FMath::Min(WeightMaxAddAmount, QuantityMaxAddAmount);
+			// The room on the stack, as far as the weight left allows
+			const int32 AddAmount = SIInventory::GetStackAddAmount(InvItem->GetQuantity(), InvItem->GetMaxStackSize(), Item->GetQuantity(), GetRemainingWeight(), Item->GetUnitWeight());
 
 			if (AddAmount > 0)
 			{
@@ -383,79 +1398,61 @@ FSIItemAddResult USIInventoryComponent::TryAddItem_Internal(USIItem* Item, const
 				{
 					ClientRefreshInventory();
 					
-					return FSIItemAddResult::AddedAll(Item, Item->GetQuantity());
+					return FSIItemAddResult::AddedAll(Item, Quantity);
 				}
 				
 				Item->SetQuantity(Item->GetQuantity() - AddAmount);
 			}
 		}
-		else if (IsRoomAvailable(Item, TopLeftIndex, false))
+		else if (IsRoomAvailable(Item, TopLeftIndex, false) && SIInventory::GetMaxQuantityForWeight(GetRemainingWeight(), Item->GetUnitWeight(), Item->GetQuantity()) >= Item->GetQuantity())
 		{
-			AddItem(Item, TopLeftIndex, Item->GetQuantity());
+			AddItem(Item, TopLeftIndex, Item->GetQuantity(), Item->GetNewRotated());
 
-			return FSIItemAddResult::AddedAll(Item, Item->GetQuantity());
+			return FSIItemAddResult::AddedAll(Item, Quantity);
 		}
 		
-		// Try Add At Another Place
-		for (int32 Index = 0; Index < Items.Num(); Index++)
+		// Try Add At Another Place, the way the item is about to lie and then turned. Only the anchors the item fits at are
+		// visited, and since adding a stack changes the mask the next anchor is looked up in the rebuilt one. The item itself
+		// is never rotated for this, that would journal and broadcast a rotation for every attempt
+		const FIntPoint Dimensions = Item->GetDimensions(false);
+		const bool bCanTurn = Dimensions.X != Dimensions.Y;
+
+		for (const bool bTurned : { false, true })
 		{
-			if (IsRoomAvailable(Item, Index, false))
+			if (bTurned && !bCanTurn)
 			{
-				const int32 WeightMaxAddAmount = FMath::IsNearlyZero(Item->Weight)
-					? Item->GetQuantity()
-					: FMath::FloorToInt((GetWeightCapacity() - GetCurrentWeight()) / Item->Weight);
-				const int32 QuantityMaxAddAmount = FMath::Min(Item->MaxStackSize, Item->GetQuantity());
-				const int32 AddAmount = FMath::Min(WeightMaxAddAmount, QuantityMaxAddAmount);
-
-				if (AddAmount <= 0)
-				{
-					return FSIItemAddResult::AddedNone(Item->GetQuantity(), FText::Format(FText::FromString("Couldn't add {ItemName} to Inventory. Inventory is full."), Item->DisplayName));
-				}
-
-				USIItem* NewItem = AddItem(Item, Index, AddAmount);
-
-				if (AddAmount < Item->GetQuantity())
-				{
-					Item->SetQuantity(Item->GetQuantity() - AddAmount);
-			
-					continue;
-				}
-
-				return FSIItemAddResult::AddedAll(Item, Item->GetQuantity());
+				break;
 			}
-		}
 
-		Item->Rotate();
+			const FIntPoint TryDimensions = bTurned ? FIntPoint(Dimensions.Y, Dimensions.X) : Dimensions;
+			const bool bPlaceRotated = Item->GetNewRotated() != bTurned;
 
-		for (int32 Index = 0; Index < Items.Num(); Index++)
-		{
-			if (IsRoomAvailable(Item, Index, false))
+			for (int32 Index = GetFootprintMask(TryDimensions, Item).FindFrom(true, 0); Index != INDEX_NONE; Index = GetFootprintMask(TryDimensions, Item).FindFrom(true, Index + 1))
 			{
-				const int32 WeightMaxAddAmount = FMath::IsNearlyZero(Item->Weight)
-					? Item->GetQuantity()
-					: FMath::FloorToInt((GetWeightCapacity() - GetCurrentWeight()) / Item->Weight);
-				const int32 QuantityMaxAddAmount = FMath::Min(Item->MaxStackSize, Item->GetQuantity());
-				const int32 AddAmount = FMath::Min(WeightMaxAddAmount, QuantityMaxAddAmount);
+				const int32 AddAmount = SIInventory::GetNewStackAmount(Item->GetMaxStackSize(), Item->GetQuantity(), GetRemainingWeight(), Item->GetUnitWeight());
 
 				if (AddAmount <= 0)
 				{
-					return FSIItemAddResult::AddedNone(Item->GetQuantity(), FText::Format(FText::FromString("Couldn't add {ItemName} to Inventory. Inventory is full."), Item->DisplayName));
+					break;
 				}
 
-				USIItem* NewItem = AddItem(Item, Index, AddAmount);
+				AddItem(Item, Index, AddAmount, bPlaceRotated);
 
 				if (AddAmount < Item->GetQuantity())
 				{
 					Item->SetQuantity(Item->GetQuantity() - AddAmount);
-			
+
 					continue;
 				}
 
-				return FSIItemAddResult::AddedAll(Item, Item->GetQuantity());
+				return FSIItemAddResult::AddedAll(Item, Quantity);
 			}
 		}
 
-		Item->Rotate();
+		// Some of it may have gone onto a stack or into a new one before the room or the weight ran out
+		return Item->GetQuantity() < Quantity
+			? FSIItemAddResult::AddedSome(Item, Quantity, Quantity - Item->GetQuantity(), FullText)
+			: FSIItemAddResult::AddedNone(Quantity, FullText);
 	}
 
 	return FSIItemAddResult::AddedNone(-1, FText::FromString(""));
@@ -467,52 +1464,239 @@ bool USIInventoryComponent::IsRoomAvailable(USIItem* Item, int32 TopLeftIndex, c
 	{
 		return false;
 	}
-	
-	FInventoryTile Tile = IndexToTile(TopLeftIndex);
-	FIntPoint Dimensions = Item->GetDimensions(bCurrentDimensions);
 
-	for (int32 I = Tile.X; I < Tile.X + Dimensions.X; I++)
+	return SIInventory::IsRoomAvailable(GetGridShape(), TopLeftIndex, Item->GetDimensions(bCurrentDimensions), [this, Item](const int32 Index)
+	{
+		const USIItem* TargetItem = GetItemAtIndex(Index);
+
+		return TargetItem && TargetItem != Item;
+	});
+}
+
+const TBitArray<>& USIInventoryComponent::GetPlacementMask(USIItem* Item, const bool bCurrentDimensions/* = true*/) const
+{
+	return GetFootprintMask(Item ? Item->GetDimensions(bCurrentDimensions) : FIntPoint(1, 1), Item);
+}
+
+const TBitArray<>& USIInventoryComponent::GetFootprintMask(const FIntPoint Dimensions, const USIItem* Item) const
+{
+	FPlacementMask* PlacementMask = PlacementMasks.FindByPredicate([&Dimensions, Item](const FPlacementMask& Other)
+	{
+		return Other.Dimensions == Dimensions && Other.IgnoredItem == Item;
+	});
+
+	if (!PlacementMask)
 	{
-		for (int32 J = Tile.Y; J < Tile.Y + Dimensions.Y; J++)
+		if (PlacementMasks.Num() < 4)
+		{
+			PlacementMask = &PlacementMasks.AddDefaulted_GetRef();
+		}
+		else
 		{
-			FInventoryTile TargetTile(I, J);
+			PlacementMask = &PlacementMasks[NextPlacementMask];
+			NextPlacementMask = (NextPlacementMask + 1) % PlacementMasks.Num();
+		}
 
-			if (!IsTileValid(TargetTile))
-			{
-				return false;
-			}
-			
-			int32 TargetIndex = TileToIndex(TargetTile);
-			
-			if (!Items.IsValidIndex(TargetIndex))
+		PlacementMask->Dimensions = Dimensions;
+		PlacementMask->IgnoredItem = Item;
+		PlacementMask->Version = INDEX_NONE;
+	}
+
+	if (PlacementMask->Version != InventoryVersion || PlacementMask->Mask.Num() != GetCapacity())
+	{
+		BuildPlacementMask(*PlacementMask);
+	}
+
+	return PlacementMask->Mask;
+}
+
+void USIInventoryComponent::BuildPlacementMask(FPlacementMask& PlacementMask) const
+{
+	PlacementMask.Version = InventoryVersion;
+
+	if (!bChunkedStorage && Items.Num() < GetCapacity())
+	{
+		PlacementMask.Mask.Init(false, FMath::Max(GetCapacity(), 0));
+		return;
+	}
+
+	TBitArray<> Occupied;
+	BuildOccupancy(Occupied, PlacementMask.IgnoredItem);
+
+	SIInventory::BuildPlacementMask(GetGridShape(), Occupied, PlacementMask.Dimensions, PlacementMask.Mask);
+}
+
+void USIInventoryComponent::BuildOccupancy(TBitArray<>& OutOccupied, const USIItem* IgnoredItem) const
+{
+	OutOccupied.Init(false, FMath::Max(GetCapacity(), 0));
+
+	ForEachOccupiedTile([&OutOccupied, IgnoredItem](int32 Index, USIItem* TileItem)
+	{
+		if (TileItem != IgnoredItem)
+		{
+			OutOccupied[Index] = true;
+		}
+	});
+}
+
+bool USIInventoryComponent::CanPlaceItemAtIndex(USIItem* Item, const int32 TopLeftIndex, const bool bCurrentDimensions) const
+{
+	const TBitArray<>& Mask = GetPlacementMask(Item, bCurrentDimensions);
+
+	return Mask.IsValidIndex(TopLeftIndex) && Mask[TopLeftIndex];
+}
+
+bool USIInventoryComponent::CanPlaceItemAt(USIItem* Item, FInventoryTile Tile, const bool bCurrentDimensions/* = true*/) const
+{
+	return Item && IsTileValid(Tile) && CanPlaceItemAtIndex(Item, TileToIndex(Tile), bCurrentDimensions);
+}
+
+TArray<FInventoryTile> USIInventoryComponent::GetValidPlacementTiles(USIItem* Item, const bool bCurrentDimensions/* = true*/) const
+{
+	TArray<FInventoryTile> Tiles;
+
+	if (Item)
+	{
+		for (TConstSetBitIterator<> It(GetPlacementMask(Item, bCurrentDimensions)); It; ++It)
+		{
+			Tiles.Add(IndexToTile(It.GetIndex()));
+		}
+	}
+
+	return Tiles;
+}
+
+USIItem* USIInventoryComponent::GetItemAtIndex(const int32 Index) const
+{
+	if (!bChunkedStorage)
+	{
+		return Items.IsValidIndex(Index) ? Items[Index] : nullptr;
+	}
+
+	if (!IsIndexValid(Index))
+	{
+		return nullptr;
+	}
+
+	const FInventoryTile Tile = IndexToTile(Index);
+	const int32* ChunkIndex = ChunkLookup.Find(FIntPoint(Tile.X / ChunkSize, Tile.Y / ChunkSize));
+
+	return ChunkIndex ? ItemChunks.Chunks[*ChunkIndex].Cells[(Tile.Y % ChunkSize) * ChunkSize + Tile.X % ChunkSize] : nullptr;
+}
+
+void USIInventoryComponent::SetItemAtIndex(const int32 Index, USIItem* Item)
+{
+	if (!bChunkedStorage)
+	{
+		if (Items.IsValidIndex(Index))
+		{
+			Items[Index] = Item;
+		}
+
+		return;
+	}
+
+	if (!IsIndexValid(Index))
+	{
+		return;
+	}
+
+	const FInventoryTile Tile = IndexToTile(Index);
+	const FIntPoint Coord(Tile.X / ChunkSize, Tile.Y / ChunkSize);
+	const int32 CellIndex = (Tile.Y % ChunkSize) * ChunkSize + Tile.X % ChunkSize;
+
+	int32 ChunkIndex = INDEX_NONE;
+
+	if (const int32* FoundChunkIndex = ChunkLookup.Find(Coord))
+	{
+		ChunkIndex = *FoundChunkIndex;
+	}
+	else if (Item)
+	{
+		FSIInventoryChunk& NewChunk = ItemChunks.Chunks.AddDefaulted_GetRef();
+		NewChunk.Coord = Coord;
+
+		ChunkIndex = ItemChunks.Chunks.Num() - 1;
+		ChunkLookup.Add(Coord, ChunkIndex);
+	}
+	else
+	{
+		return;
+	}
+
+	FSIInventoryChunk& Chunk = ItemChunks.Chunks[ChunkIndex];
+	Chunk.Cells[CellIndex] = Item;
+
+	if (!Item && Chunk.IsEmpty())
+	{
+		// Free the chunk as soon as it is empty, so neither memory nor replication pay for empty space
+		ItemChunks.Chunks.RemoveAtSwap(ChunkIndex, 1, false);
+		ItemChunks.MarkArrayDirty();
+
+		RebuildChunkLookup();
+	}
+	else
+	{
+		ItemChunks.MarkItemDirty(Chunk);
+	}
+}
+
+void USIInventoryComponent::ForEachOccupiedTile(TFunctionRef<void(int32 Index, USIItem* Item)> Func) const
+{
+	if (!bChunkedStorage)
+	{
+		for (int32 Index = 0; Index < Items.Num(); Index++)
+		{
+			if (USIItem* Item = Items[Index])
 			{
-				return false;
+				Func(Index, Item);
 			}
-			
-			USIItem* TargetItem = Items[TargetIndex];
+		}
+
+		return;
+	}
 
-			if (TargetItem && TargetItem != Item)
+	for (const FSIInventoryChunk& Chunk : ItemChunks.Chunks)
+	{
+		for (int32 CellIndex = 0; CellIndex < ChunkSize * ChunkSize; CellIndex++)
+		{
+			if (USIItem* Item = Chunk.Cells[CellIndex])
 			{
-				return false;
+				const FInventoryTile Tile(Chunk.Coord.X * ChunkSize + CellIndex % ChunkSize, Chunk.Coord.Y * ChunkSize + CellIndex / ChunkSize);
+
+				if (IsTileValid(Tile))
+				{
+					Func(TileToIndex(Tile), Item);
+				}
 			}
 		}
 	}
+}
 
-	return true;
+void USIInventoryComponent::RebuildChunkLookup()
+{
+	ChunkLookup.Reset();
+
+	for (int32 ChunkIndex = 0; ChunkIndex < ItemChunks.Chunks.Num(); ChunkIndex++)
+	{
+		ChunkLookup.Add(ItemChunks.Chunks[ChunkIndex].Coord, ChunkIndex);
+	}
 }
 
 FInventoryTile USIInventoryComponent::IndexToTile(int32 Index) const
 {
-	return FInventoryTile(Index % Columns, Index / Columns);
+	const FIntPoint Tile = GetGridShape().IndexToTile(Index);
+
+	return FInventoryTile(Tile.X, Tile.Y);
 }
 
 int32 USIInventoryComponent::TileToIndex(FInventoryTile Tile) const
 {
-	return Tile.X + (Tile.Y * Columns);
+	return GetGridShape().TileToIndex(FIntPoint(Tile.X, Tile.Y));
 }
 
 bool USIInventoryComponent::IsTileValid(FInventoryTile Tile) const
 {
-	return Tile.X >= 0 && Tile.Y >= 0 && Tile.X < Columns && Tile.Y < Rows;
+	return GetGridShape().IsTileValid(FIntPoint(Tile.X, Tile.Y));
 }
 
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/SIInventoryViewerContents.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "Net/UnrealNetwork.h"
+
+void USIInventoryViewerContents::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(USIInventoryViewerContents, Cells);
+}
+
+bool USIInventoryViewerContents::IsSupportedForNetworking() const
+{
+	return true;
+}
+
+void USIInventoryViewerContents::CopyFrom(const USIInventoryComponent* Inventory)
+{
+	Cells.Reset(Inventory->GetCapacity());
+
+	for (int32 Index = 0; Index < Inventory->GetCapacity(); Index++)
+	{
+		Cells.Add(Inventory->GetItemAtIndex(Index));
+	}
+}
+
+void USIInventoryViewerContents::OnRep_Cells()
+{
+	if (USIInventoryComponent* Inventory = GetTypedOuter<USIInventoryComponent>())
+	{
+		Inventory->ApplyViewerContents(Cells);
+	}
+}
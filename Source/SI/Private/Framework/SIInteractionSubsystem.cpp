@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Framework/SIInteractionSubsystem.h"
+
+#include "Components/SIInteractionComponent.h"
+#include "Player/SICharacter.h"
+
+void USIInteractionSubsystem::Deinitialize()
+{
+	Interactables.Empty();
+	Cells.Empty();
+	InteractableCells.Empty();
+	ActiveInteractions.Empty();
+
+	Super::Deinitialize();
+}
+
+void USIInteractionSubsystem::Tick(float DeltaTime)
+{
+	TArray<ASICharacter*, TInlineAllocator<8>> CompletedInteractors;
+
+	for (int32 Index = ActiveInteractions.Num() - 1; Index >= 0; Index--)
+	{
+		FSIActiveInteraction& Interaction = ActiveInteractions[Index];
+
+		if (!IsValid(Interaction.Character) || !IsValid(Interaction.Interactable))
+		{
+			ActiveInteractions.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		Interaction.Elapsed += DeltaTime;
+
+		const float Progress = FMath::Clamp(Interaction.Elapsed / Interaction.Duration, 0.f, 1.f);
+		Interaction.Interactable->SetInteractProgress(Interaction.Character, Progress);
+
+		if (Interaction.Elapsed >= Interaction.Duration)
+		{
+			// EndInteraction won't find this entry anymore once Interact runs, so the progress is reset here
+			Interaction.Interactable->SetInteractProgress(Interaction.Character, 0.f);
+
+			CompletedInteractors.Add(Interaction.Character);
+			ActiveInteractions.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	// Interacting can start or end other interactions, so only do it once we are done with the array
+	for (ASICharacter* Interactor : CompletedInteractors)
+	{
+		Interactor->Interact();
+	}
+}
+
+ETickableTickType USIInteractionSubsystem::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId USIInteractionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USIInteractionSubsystem, STATGROUP_Tickables);
+}
+
+void USIInteractionSubsystem::RegisterInteractable(USIInteractionComponent* Interactable)
+{
+	if (Interactable && Interactable->GetOwner())
+	{
+		// Like GetComponentByClass, the first interaction component of an actor is the one that is used
+		if (!Interactables.Contains(Interactable->GetOwner()))
+		{
+			Interactables.Add(Interactable->GetOwner(), Interactable);
+			AddToCell(Interactable, GetCell(Interactable->GetOwner()->GetActorLocation()));
+		}
+	}
+}
+
+void USIInteractionSubsystem::UnregisterInteractable(USIInteractionComponent* Interactable)
+{
+	if (Interactable && Interactable->GetOwner())
+	{
+		if (FindInteractable(Interactable->GetOwner()) == Interactable)
+		{
+			Interactables.Remove(Interactable->GetOwner());
+			RemoveFromCell(Interactable);
+		}
+	}
+}
+
+void USIInteractionSubsystem::UpdateInteractable(USIInteractionComponent* Interactable)
+{
+	if (Interactable && Interactable->GetOwner())
+	{
+		if (const FIntVector* CurrentCell = InteractableCells.Find(Interactable))
+		{
+			const FIntVector NewCell = GetCell(Interactable->GetOwner()->GetActorLocation());
+
+			if (NewCell != *CurrentCell)
+			{
+				RemoveFromCell(Interactable);
+				AddToCell(Interactable, NewCell);
+			}
+		}
+	}
+}
+
+void USIInteractionSubsystem::GatherInteractables(const FVector& Location, const float Radius, TArray<USIInteractionComponent*, TInlineAllocator<32>>& OutInteractables) const
+{
+	const FIntVector MinCell = GetCell(Location - FVector(Radius));
+	const FIntVector MaxCell = GetCell(Location + FVector(Radius));
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				if (const TArray<USIInteractionComponent*>* CellInteractables = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					OutInteractables.Append(*CellInteractables);
+				}
+			}
+		}
+	}
+}
+
+void USIInteractionSubsystem::BeginInteraction(ASICharacter* Character, USIInteractionComponent* Interactable)
+{
+	if (!Character || !Interactable)
+	{
+		return;
+	}
+
+	const int32 Index = FindActiveInteraction(Character);
+	FSIActiveInteraction& Interaction = Index != INDEX_NONE ? ActiveInteractions[Index] : ActiveInteractions.AddDefaulted_GetRef();
+
+	Interaction.Character = Character;
+	Interaction.Interactable = Interactable;
+	Interaction.Elapsed = 0.f;
+	Interaction.Duration = Interactable->InteractionTime;
+
+	Interactable->SetInteractProgress(Character, 0.f);
+}
+
+void USIInteractionSubsystem::EndInteraction(ASICharacter* Character)
+{
+	const int32 Index = FindActiveInteraction(Character);
+
+	if (Index != INDEX_NONE)
+	{
+		if (USIInteractionComponent* Interactable = ActiveInteractions[Index].Interactable)
+		{
+			Interactable->SetInteractProgress(Character, 0.f);
+		}
+
+		ActiveInteractions.RemoveAtSwap(Index, 1, false);
+	}
+}
+
+bool USIInteractionSubsystem::IsInteracting(const ASICharacter* Character) const
+{
+	return FindActiveInteraction(Character) != INDEX_NONE;
+}
+
+float USIInteractionSubsystem::GetRemainingInteractTime(const ASICharacter* Character) const
+{
+	const int32 Index = FindActiveInteraction(Character);
+
+	return Index != INDEX_NONE ? FMath::Max(ActiveInteractions[Index].Duration - ActiveInteractions[Index].Elapsed, 0.f) : 0.f;
+}
+
+int32 USIInteractionSubsystem::FindActiveInteraction(const ASICharacter* Character) const
+{
+	return ActiveInteractions.IndexOfByPredicate([Character](const FSIActiveInteraction& Interaction)
+	{
+		return Interaction.Character == Character;
+	});
+}
+
+FIntVector USIInteractionSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void USIInteractionSubsystem::AddToCell(USIInteractionComponent* Interactable, const FIntVector& Cell)
+{
+	Cells.FindOrAdd(Cell).Add(Interactable);
+	InteractableCells.Add(Interactable, Cell);
+}
+
+void USIInteractionSubsystem::RemoveFromCell(USIInteractionComponent* Interactable)
+{
+	FIntVector Cell;
+
+	if (InteractableCells.RemoveAndCopyValue(Interactable, Cell))
+	{
+		if (TArray<USIInteractionComponent*>* CellInteractables = Cells.Find(Cell))
+		{
+			CellInteractables->RemoveSingleSwap(Interactable, false);
+
+			if (CellInteractables->Num() == 0)
+			{
+				Cells.Remove(Cell);
+			}
+		}
+	}
+}
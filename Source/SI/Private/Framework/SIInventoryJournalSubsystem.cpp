@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Framework/SIInventoryJournalSubsystem.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "Misc/Paths.h"
+
+void USIInventoryJournalSubsystem::Deinitialize()
+{
+	// End on a complete checkpoint, the next start then has nothing to replay
+	if (Writer)
+	{
+		if (!bCheckpointInProgress)
+		{
+			BeginCheckpoint();
+		}
+
+		CaptureCheckpoint(MAX_int32);
+		SubmitPendingBatch();
+
+		Writer->Shutdown();
+		Writer.Reset();
+	}
+
+	for (const FJournaledInventory& Journaled : JournaledInventories)
+	{
+		if (USIInventoryComponent* Inventory = Journaled.Inventory.Get())
+		{
+			Inventory->Journal = nullptr;
+		}
+	}
+
+	JournaledInventories.Empty();
+	PendingSnapshots.Empty();
+	CheckpointQueue.Empty();
+	RecoveredSnapshots.Empty();
+
+	Super::Deinitialize();
+}
+
+void USIInventoryJournalSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceCheckpoint += DeltaTime;
+
+	for (const TWeakObjectPtr<USIInventoryComponent>& Inventory : PendingSnapshots)
+	{
+		RecordSnapshot(Inventory.Get());
+	}
+
+	PendingSnapshots.Reset();
+
+	if (!bCheckpointInProgress && (bCheckpointRequested || TimeSinceCheckpoint >= CheckpointInterval))
+	{
+		BeginCheckpoint();
+	}
+
+	if (bCheckpointInProgress)
+	{
+		CaptureCheckpoint(MaxCheckpointCapturesPerFrame);
+	}
+
+	SubmitPendingBatch();
+}
+
+bool USIInventoryJournalSubsystem::IsTickable() const
+{
+	return Writer.IsValid();
+}
+
+ETickableTickType USIInventoryJournalSubsystem::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId USIInventoryJournalSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USIInventoryJournalSubsystem, STATGROUP_Tickables);
+}
+
+void USIInventoryJournalSubsystem::RegisterInventory(USIInventoryComponent* Inventory)
+{
+	if (!Inventory || Inventory->PersistenceKey.IsEmpty() || Inventory->Journal == this || !EnsureWriter())
+	{
+		return;
+	}
+
+	// Loading normally took what was recovered for the key. Without a database to load from, it is restored here
+	FSIInventorySnapshot RecoveredSnapshot;
+
+	if (TakeRecoveredSnapshot(Inventory->PersistenceKey, RecoveredSnapshot))
+	{
+		Inventory->RestoreSnapshot(RecoveredSnapshot);
+	}
+
+	FJournaledInventory& Journaled = JournaledInventories.AddDefaulted_GetRef();
+	Journaled.Inventory = Inventory;
+	Journaled.Key = Inventory->PersistenceKey;
+	Journaled.KeyId = GetKeyId(Journaled.Key);
+
+	Inventory->Journal = this;
+	Inventory->JournalKeyId = Journaled.KeyId;
+
+	// The live contents are what the checkpoints and the changes from here on build on
+	RecordSnapshot(Inventory);
+}
+
+void USIInventoryJournalSubsystem::UnregisterInventory(USIInventoryComponent* Inventory)
+{
+	const int32 Index = JournaledInventories.IndexOfByPredicate([Inventory](const FJournaledInventory& Journaled)
+	{
+		return Journaled.Inventory.Get() == Inventory;
+	});
+
+	if (Index != INDEX_NONE)
+	{
+		JournaledInventories.RemoveAtSwap(Index, 1, false);
+	}
+
+	if (Inventory && Inventory->Journal == this)
+	{
+		Inventory->Journal = nullptr;
+		Inventory->JournalKeyId = INDEX_NONE;
+	}
+}
+
+bool USIInventoryJournalSubsystem::TakeRecoveredSnapshot(const FString& Key, FSIInventorySnapshot& OutSnapshot)
+{
+	// Loads are the first thing the server does with saved inventories, which makes this where the journal is recovered
+	return EnsureWriter() && RecoveredSnapshots.RemoveAndCopyValue(Key, OutSnapshot);
+}
+
+void USIInventoryJournalSubsystem::RecordSnapshot(USIInventoryComponent* Inventory)
+{
+	if (Inventory && Inventory->Journal == this)
+	{
+		RecordEntry(ESIInventoryJournalOp::Snapshot, Inventory->JournalKeyId, 0, 0, false);
+		PendingBatch.Snapshots.Emplace(Inventory->JournalKeyId, Inventory->CreateSnapshot());
+	}
+}
+
+void USIInventoryJournalSubsystem::RequestSnapshot(USIInventoryComponent* Inventory)
+{
+	if (Inventory && Inventory->Journal == this)
+	{
+		PendingSnapshots.AddUnique(Inventory);
+	}
+}
+
+FString USIInventoryJournalSubsystem::GetJournalPath() const
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), JournalDirectory);
+}
+
+bool USIInventoryJournalSubsystem::EnsureWriter()
+{
+	if (!Writer && bEnableJournal && !bWriterFailed)
+	{
+		// Read before the writer starts its first checkpoint, which deletes the files left behind
+		if (FSIInventoryJournalWriter::Recover(GetJournalPath(), RecoveredSnapshots))
+		{
+			UE_LOG(LogTemp, Log, TEXT("Recovered %d inventories from the inventory journal."), RecoveredSnapshots.Num());
+		}
+
+		Writer = MakeUnique<FSIInventoryJournalWriter>(GetJournalPath());
+
+		if (!Writer->Start())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Couldn't start the inventory journal writer, inventories won't be journaled."));
+
+			Writer.Reset();
+			bWriterFailed = true;
+		}
+	}
+
+	return Writer.IsValid();
+}
+
+int32 USIInventoryJournalSubsystem::AddTypeId(UClass* ItemClass)
+{
+	const int32 TypeId = TypeIds.Num();
+
+	TypeIds.Add(ItemClass, TypeId);
+	PendingBatch.NewTypes.Emplace(TypeId, ItemClass ? ItemClass->GetPathName() : FString());
+
+	return TypeId;
+}
+
+int32 USIInventoryJournalSubsystem::GetKeyId(const FString& Key)
+{
+	if (const int32* KeyId = KeyIds.Find(Key))
+	{
+		return *KeyId;
+	}
+
+	const int32 KeyId = KeyIds.Num();
+
+	KeyIds.Add(Key, KeyId);
+	PendingBatch.NewKeys.Emplace(KeyId, Key);
+
+	return KeyId;
+}
+
+void USIInventoryJournalSubsystem::BeginCheckpoint()
+{
+	bCheckpointRequested = false;
+	bCheckpointInProgress = true;
+	TimeSinceCheckpoint = 0.f;
+
+	PendingBatch.bCheckpointStart = true;
+
+	JournaledInventories.RemoveAllSwap([](const FJournaledInventory& Journaled)
+	{
+		return !Journaled.Inventory.IsValid();
+	});
+
+	CheckpointQueue = JournaledInventories;
+
+	// Recovered contents of keys nobody registered yet would be lost to the next crash otherwise. They are plain data
+	// already, so they don't count against the captures
+	for (const TPair<FString, FSIInventorySnapshot>& Recovered : RecoveredSnapshots)
+	{
+		PendingBatch.Checkpoint.Emplace(GetKeyId(Recovered.Key), Recovered.Value);
+	}
+}
+
+bool USIInventoryJournalSubsystem::CaptureCheckpoint(const int32 MaxCaptures)
+{
+	int32 Captures = 0;
+
+	while (CheckpointQueue.Num() > 0 && Captures < MaxCaptures)
+	{
+		const FJournaledInventory Journaled = CheckpointQueue.Pop(false);
+		USIInventoryComponent* Inventory = Journaled.Inventory.Get();
+
+		// Gone or unregistered since the checkpoint started
+		if (!Inventory || Inventory->Journal != this || Inventory->JournalKeyId != Journaled.KeyId)
+		{
+			continue;
+		}
+
+		PendingBatch.Checkpoint.Emplace(Journaled.KeyId, Inventory->CreateSnapshot());
+		Captures++;
+	}
+
+	if (CheckpointQueue.Num() > 0)
+	{
+		return false;
+	}
+
+	PendingBatch.bCheckpointEnd = true;
+	bCheckpointInProgress = false;
+
+	return true;
+}
+
+void USIInventoryJournalSubsystem::SubmitPendingBatch()
+{
+	if (Writer && (PendingBatch.bCheckpointStart || PendingBatch.bCheckpointEnd || PendingBatch.Checkpoint.Num() > 0 || PendingBatch.Entries.Num() > 0 || PendingBatch.NewKeys.Num() > 0 || PendingBatch.NewTypes.Num() > 0))
+	{
+		Writer->EnqueueBatch(MoveTemp(PendingBatch));
+		PendingBatch = FSIInventoryJournalBatch();
+	}
+}
@@ -0,0 +1,262 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Framework/SIInventoryPersistenceSubsystem.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "Framework/SIInventoryJournalSubsystem.h"
+#include "Misc/Paths.h"
+#include "Persistence/SIInventorySQLiteBackend.h"
+
+void USIInventoryPersistenceSubsystem::Deinitialize()
+{
+	// Clean flush, everything changed is captured now and the writer is waited on
+	if (Writer)
+	{
+		CaptureCursor = 0;
+		CaptureChangedInventories(MAX_int32);
+
+		Writer->Shutdown();
+		Writer.Reset();
+	}
+
+	TrackedInventories.Empty();
+
+	Super::Deinitialize();
+}
+
+void USIInventoryPersistenceSubsystem::Tick(float DeltaTime)
+{
+	if (!bCaptureInProgress)
+	{
+		TimeSinceFlush += DeltaTime;
+
+		if (TimeSinceFlush < FlushInterval)
+		{
+			return;
+		}
+
+		TimeSinceFlush = 0.f;
+		CaptureCursor = 0;
+		bCaptureInProgress = true;
+	}
+
+	if (CaptureChangedInventories(MaxCapturesPerFrame))
+	{
+		bCaptureInProgress = false;
+		Writer->Flush();
+	}
+}
+
+bool USIInventoryPersistenceSubsystem::IsTickable() const
+{
+	return Writer.IsValid() && TrackedInventories.Num() > 0;
+}
+
+ETickableTickType USIInventoryPersistenceSubsystem::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId USIInventoryPersistenceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USIInventoryPersistenceSubsystem, STATGROUP_Tickables);
+}
+
+void USIInventoryPersistenceSubsystem::RegisterInventory(USIInventoryComponent* Inventory, TFunction<void(bool)> OnLoaded)
+{
+	const bool bAlreadyTracked = TrackedInventories.ContainsByPredicate([Inventory](const FTrackedInventory& Tracked)
+	{
+		return Tracked.Inventory.Get() == Inventory;
+	});
+
+	if (!Inventory || Inventory->PersistenceKey.IsEmpty() || bAlreadyTracked || !EnsureWriter())
+	{
+		if (OnLoaded)
+		{
+			OnLoaded(false);
+		}
+
+		return;
+	}
+
+	// Only the changes from here on are saved, and none before the load is done
+	FTrackedInventory& Tracked = TrackedInventories.AddDefaulted_GetRef();
+	Tracked.Inventory = Inventory;
+	Tracked.Key = Inventory->PersistenceKey;
+	Tracked.CapturedVersion = Inventory->GetContentsVersion();
+
+	LoadInventory(Inventory, MoveTemp(OnLoaded));
+}
+
+void USIInventoryPersistenceSubsystem::UnregisterInventory(USIInventoryComponent* Inventory)
+{
+	const int32 Index = TrackedInventories.IndexOfByPredicate([Inventory](const FTrackedInventory& Tracked)
+	{
+		return Tracked.Inventory.Get() == Inventory;
+	});
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Left before its load was done, what it holds isn't what is saved and mustn't replace it
+	if (Writer && TrackedInventories[Index].PendingLoads == 0 && Inventory->GetContentsVersion() != TrackedInventories[Index].CapturedVersion)
+	{
+		Writer->EnqueueWrite(TrackedInventories[Index].Key, Inventory->CreateSnapshot());
+		Writer->Flush();
+	}
+
+	TrackedInventories.RemoveAt(Index, 1, false);
+
+	if (Index < CaptureCursor)
+	{
+		CaptureCursor--;
+	}
+}
+
+void USIInventoryPersistenceSubsystem::LoadInventory(USIInventoryComponent* Inventory, TFunction<void(bool)> OnLoaded)
+{
+	if (!Inventory || Inventory->PersistenceKey.IsEmpty() || !EnsureWriter())
+	{
+		if (OnLoaded)
+		{
+			OnLoaded(false);
+		}
+
+		return;
+	}
+
+	const FString Key = Inventory->PersistenceKey;
+
+	if (FTrackedInventory* Tracked = FindTrackedInventory(Inventory, Key))
+	{
+		Tracked->PendingLoads++;
+	}
+
+	TWeakObjectPtr<USIInventoryComponent> WeakInventory = Inventory;
+	TWeakObjectPtr<USIInventoryPersistenceSubsystem> WeakThis = this;
+
+	Writer->EnqueueRead(Key, [WeakInventory, WeakThis, Key, OnLoaded = MoveTemp(OnLoaded)](TOptional<FSIInventorySnapshot> Snapshot)
+	{
+		USIInventoryComponent* LoadedInventory = WeakInventory.Get();
+
+		if (FTrackedInventory* Tracked = WeakThis.IsValid() ? WeakThis->FindTrackedInventory(LoadedInventory, Key) : nullptr)
+		{
+			Tracked->PendingLoads--;
+		}
+
+		// The key changed while this was read, the contents belong to another inventory now
+		if (LoadedInventory && LoadedInventory->PersistenceKey != Key)
+		{
+			LoadedInventory = nullptr;
+		}
+
+		USIInventoryJournalSubsystem* Journal = WeakThis.IsValid() ? WeakThis->GetGameInstance()->GetSubsystem<USIInventoryJournalSubsystem>() : nullptr;
+
+		// Whatever the journal recovered after a crash is newer than what made it into the database
+		FSIInventorySnapshot RecoveredSnapshot;
+		const bool bRecovered = LoadedInventory && Journal && Journal->TakeRecoveredSnapshot(Key, RecoveredSnapshot);
+
+		bool bLoaded = false;
+
+		if (bRecovered)
+		{
+			bLoaded = LoadedInventory->RestoreSnapshot(RecoveredSnapshot);
+		}
+		else if (LoadedInventory && Snapshot.IsSet())
+		{
+			bLoaded = LoadedInventory->RestoreSnapshot(Snapshot.GetValue());
+		}
+
+		// What was just loaded is what is stored, no need to write it back. Recovered contents still have to be
+		if (LoadedInventory && WeakThis.IsValid() && !bRecovered && Snapshot.IsSet())
+		{
+			if (FTrackedInventory* Tracked = WeakThis->FindTrackedInventory(LoadedInventory, Key))
+			{
+				Tracked->CapturedVersion = LoadedInventory->GetContentsVersion();
+			}
+		}
+
+		if (OnLoaded)
+		{
+			OnLoaded(bLoaded);
+		}
+	});
+}
+
+void USIInventoryPersistenceSubsystem::FlushNow()
+{
+	if (Writer)
+	{
+		CaptureCursor = 0;
+		bCaptureInProgress = false;
+		TimeSinceFlush = 0.f;
+
+		CaptureChangedInventories(MAX_int32);
+		Writer->Flush();
+	}
+}
+
+TUniquePtr<ISIInventoryPersistenceBackend> USIInventoryPersistenceSubsystem::CreateBackend() const
+{
+	return MakeUnique<FSIInventorySQLiteBackend>(FPaths::Combine(FPaths::ProjectSavedDir(), DatabaseFile));
+}
+
+bool USIInventoryPersistenceSubsystem::EnsureWriter()
+{
+	if (!Writer && bEnablePersistence && !bWriterFailed)
+	{
+		Writer = MakeUnique<FSIInventoryPersistenceWriter>(CreateBackend());
+
+		if (!Writer->Start())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Couldn't start the inventory persistence writer, inventories won't be saved."));
+
+			Writer.Reset();
+			bWriterFailed = true;
+		}
+	}
+
+	return Writer.IsValid();
+}
+
+USIInventoryPersistenceSubsystem::FTrackedInventory* USIInventoryPersistenceSubsystem::FindTrackedInventory(const USIInventoryComponent* Inventory, const FString& Key)
+{
+	return TrackedInventories.FindByPredicate([Inventory, &Key](const FTrackedInventory& Tracked)
+	{
+		return Inventory && Tracked.Inventory.Get() == Inventory && Tracked.Key == Key;
+	});
+}
+
+bool USIInventoryPersistenceSubsystem::CaptureChangedInventories(int32 Budget)
+{
+	while (CaptureCursor < TrackedInventories.Num())
+	{
+		FTrackedInventory& Tracked = TrackedInventories[CaptureCursor];
+		USIInventoryComponent* Inventory = Tracked.Inventory.Get();
+
+		if (!Inventory)
+		{
+			// Gone without unregistering, whatever changed since the last capture is lost
+			TrackedInventories.RemoveAtSwap(CaptureCursor, 1, false);
+			continue;
+		}
+
+		if (Tracked.PendingLoads == 0 && Inventory->GetContentsVersion() != Tracked.CapturedVersion)
+		{
+			if (Budget-- <= 0)
+			{
+				return false;
+			}
+
+			Tracked.CapturedVersion = Inventory->GetContentsVersion();
+			Writer->EnqueueWrite(Tracked.Key, Inventory->CreateSnapshot());
+		}
+
+		CaptureCursor++;
+	}
+
+	return true;
+}
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Framework/SIThumbnailAtlasSubsystem.h"
+
+#include "Engine/Canvas.h"
+#include "Engine/GameInstance.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Items/SIItem.h"
+#include "Kismet/KismetRenderingLibrary.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/App.h"
+
+void USIThumbnailAtlasSubsystem::Deinitialize()
+{
+	ThumbnailBrushes.Empty();
+	Atlas = nullptr;
+
+	Super::Deinitialize();
+}
+
+void USIThumbnailAtlasSubsystem::AddThumbnails(const TArray<USIItem*>& Items)
+{
+	if (!FApp::CanEverRender())
+	{
+		return;
+	}
+
+	struct FPendingThumbnail
+	{
+		UMaterialInterface* Thumbnail;
+		FIntPoint Position;
+		FIntPoint Size;
+	};
+
+	TArray<FPendingThumbnail, TInlineAllocator<16>> PendingThumbnails;
+
+	for (const USIItem* Item : Items)
+	{
+		UMaterialInterface* Thumbnail = Item ? Item->GetThumbnailAsset().Get() : nullptr;
+
+		if (!Thumbnail || ThumbnailBrushes.Contains(Thumbnail) || PendingThumbnails.ContainsByPredicate([Thumbnail](const FPendingThumbnail& Pending) { return Pending.Thumbnail == Thumbnail; }))
+		{
+			continue;
+		}
+
+		const FIntPoint Size = Item->GetBaseDimensions() * TileResolution;
+		FIntPoint Position;
+
+		// Once full, items keep drawing their own material
+		if (!EnsureAtlas() || !AllocateRegion(Size, Position))
+		{
+			break;
+		}
+
+		PendingThumbnails.Add({ Thumbnail, Position, Size });
+	}
+
+	if (PendingThumbnails.Num() == 0)
+	{
+		return;
+	}
+
+	// Draw every new thumbnail in a single canvas pass
+	UCanvas* Canvas = nullptr;
+	FVector2D CanvasSize;
+	FDrawToRenderTargetContext Context;
+
+	UKismetRenderingLibrary::BeginDrawCanvasToRenderTarget(GetGameInstance(), Atlas, Canvas, CanvasSize, Context);
+
+	for (const FPendingThumbnail& Pending : PendingThumbnails)
+	{
+		Canvas->K2_DrawMaterial(Pending.Thumbnail, FVector2D(Pending.Position), FVector2D(Pending.Size), FVector2D::ZeroVector, FVector2D::UnitVector);
+
+		const FVector2D UVMin = FVector2D(Pending.Position) / AtlasSize;
+		const FVector2D UVMax = FVector2D(Pending.Position + Pending.Size) / AtlasSize;
+
+		FSlateBrush& Brush = ThumbnailBrushes.Add(Pending.Thumbnail);
+		Brush.SetResourceObject(Atlas);
+		Brush.ImageSize = FVector2D(Pending.Size);
+		Brush.DrawAs = ESlateBrushDrawType::Image;
+		Brush.SetUVRegion(FBox2D(UVMin, UVMax));
+	}
+
+	UKismetRenderingLibrary::EndDrawCanvasToRenderTarget(GetGameInstance(), Context);
+}
+
+bool USIThumbnailAtlasSubsystem::AllocateRegion(const FIntPoint& Size, FIntPoint& OutPosition)
+{
+	if (Size.X > AtlasSize || Size.Y > AtlasSize)
+	{
+		return false;
+	}
+
+	// Doesn't fit in the current row, start a new one below it
+	if (RowCursor.X + Size.X > AtlasSize)
+	{
+		RowCursor = FIntPoint(0, RowCursor.Y + RowHeight);
+		RowHeight = 0;
+	}
+
+	if (RowCursor.Y + Size.Y > AtlasSize)
+	{
+		return false;
+	}
+
+	OutPosition = RowCursor;
+
+	RowCursor.X += Size.X;
+	RowHeight = FMath::Max(RowHeight, Size.Y);
+
+	return true;
+}
+
+bool USIThumbnailAtlasSubsystem::EnsureAtlas()
+{
+	if (!Atlas)
+	{
+		Atlas = UKismetRenderingLibrary::CreateRenderTarget2D(GetGameInstance(), AtlasSize, AtlasSize, RTF_RGBA8, FLinearColor::Transparent);
+	}
+
+	return Atlas != nullptr;
+}
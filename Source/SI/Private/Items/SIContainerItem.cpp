@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/SIContainerItem.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "GameFramework/Actor.h"
+#include "Net/UnrealNetwork.h"
+
+USIContainerItem::USIContainerItem()
+{
+	DisplayName_DEPRECATED = FText::FromString("Container");
+	UseActionText_DEPRECATED = FText::FromString("Open");
+	bStackable_DEPRECATED = false;
+	MaxStackSize_DEPRECATED = 1;
+}
+
+void USIContainerItem::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(USIContainerItem, InnerInventory);
+}
+
+void USIContainerItem::PostRename(UObject* OldOuter, const FName OldName)
+{
+	Super::PostRename(OldOuter, OldName);
+
+	// Dropping the container renames it into the pickup, the grid has to follow it onto the new actor
+	if (InnerInventory && InnerInventory->GetOwner() != GetTypedOuter<AActor>())
+	{
+		AdoptInnerInventory(InnerInventory);
+	}
+}
+
+float USIContainerItem::GetStackWeight() const
+{
+	return Super::GetStackWeight() + (InnerInventory ? InnerInventory->GetCurrentWeight() : 0.f);
+}
+
+void USIContainerItem::CopyStateFrom(USIItem* Source)
+{
+	Super::CopyStateFrom(Source);
+
+	if (USIContainerItem* SourceContainer = Cast<USIContainerItem>(Source))
+	{
+		USIInventoryComponent* SourceInventory = SourceContainer->InnerInventory;
+		SourceContainer->InnerInventory = nullptr;
+
+		AdoptInnerInventory(SourceInventory);
+	}
+}
+
+USIInventoryComponent* USIContainerItem::GetOrCreateInnerInventory()
+{
+	if (!InnerInventory)
+	{
+		AActor* InventoryOwner = GetTypedOuter<AActor>();
+
+		if (InventoryOwner && InventoryOwner->HasAuthority())
+		{
+			InnerInventory = CreateInnerInventory(InventoryOwner);
+
+			OnRep_InnerInventory();
+			MarkDirtyForReplication();
+		}
+	}
+
+	return InnerInventory;
+}
+
+void USIContainerItem::OpenFor(APlayerController* Viewer)
+{
+	if (USIInventoryComponent* Inventory = GetOrCreateInnerInventory())
+	{
+		Inventory->AddViewer(Viewer);
+	}
+}
+
+void USIContainerItem::CloseFor(APlayerController* Viewer)
+{
+	if (InnerInventory)
+	{
+		InnerInventory->RemoveViewer(Viewer);
+	}
+}
+
+FSIItemAddResult USIContainerItem::TryAddItemToContainer(USIItem* Item)
+{
+	if (USIInventoryComponent* Inventory = GetOrCreateInnerInventory())
+	{
+		return Inventory->TryAddItem(Item, FInventoryTile());
+	}
+
+	return FSIItemAddResult::AddedNone(Item ? Item->GetQuantity() : 0, FText::FromString(""));
+}
+
+void USIContainerItem::DestroyInnerInventory()
+{
+	if (!InnerInventory)
+	{
+		return;
+	}
+
+	USIInventoryComponent* Inventory = InnerInventory;
+	InnerInventory = nullptr;
+
+	// Their grids live on the same actor, they'd be left behind otherwise
+	for (const TPair<USIItem*, FInventoryTile>& ItemTile : Inventory->GetItemsMap())
+	{
+		if (USIContainerItem* NestedContainer = Cast<USIContainerItem>(ItemTile.Key))
+		{
+			NestedContainer->DestroyInnerInventory();
+		}
+	}
+
+	Inventory->OwnerContainer = nullptr;
+	Inventory->DestroyComponent();
+
+	OnRep_InnerInventory();
+	MarkDirtyForReplication();
+}
+
+void USIContainerItem::AdoptInnerInventory(USIInventoryComponent* SourceInventory)
+{
+	if (!SourceInventory)
+	{
+		return;
+	}
+
+	AActor* InventoryOwner = GetTypedOuter<AActor>();
+
+	if (SourceInventory->GetOwner() == InventoryOwner)
+	{
+		InnerInventory = SourceInventory;
+	}
+	else if (InventoryOwner && InventoryOwner->HasAuthority())
+	{
+		// Components can't change actor, recreate the grid on ours and move the contents over
+		InnerInventory = CreateInnerInventory(InventoryOwner);
+		InnerInventory->CopyContentsFrom(SourceInventory);
+
+		SourceInventory->OwnerContainer = nullptr;
+		SourceInventory->DestroyComponent();
+	}
+
+	OnRep_InnerInventory();
+	MarkDirtyForReplication();
+}
+
+USIInventoryComponent* USIContainerItem::CreateInnerInventory(AActor* InventoryOwner)
+{
+	USIInventoryComponent* Inventory = NewObject<USIInventoryComponent>(InventoryOwner);
+	Inventory->InitializeGrid(InnerRows, InnerColumns, InnerWeightCapacity);
+	Inventory->bReplicateToViewersOnly = true;
+	Inventory->OwnerContainer = this;
+	Inventory->RegisterComponent();
+
+	return Inventory;
+}
+
+void USIContainerItem::OnRep_InnerInventory()
+{
+	if (InnerInventory)
+	{
+		InnerInventory->OwnerContainer = this;
+	}
+
+	if (OwningInventory)
+	{
+		OwningInventory->MarkContentsDirty();
+	}
+
+	OnItemModified.Broadcast();
+}
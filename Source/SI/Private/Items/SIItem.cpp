@@ -4,17 +4,27 @@
 #include "Items/SIItem.h"
 
 #include "Components/SIInventoryComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/AssetManager.h"
+#include "Materials/MaterialInterface.h"
 #include "Net/UnrealNetwork.h"
+#include "SIInventoryCore.h"
+#include "UObject/Package.h"
 
 USIItem::USIItem()
 {
-	DisplayName = FText::FromString("Item");
-	UseActionText = FText::FromString("Use");
-	Weight = 0.f;
-	bStackable = true;
+	Definition = nullptr;
 	Quantity = 1;
-	MaxStackSize = 2;
 	RepKey = 0;
+
+	// The defaults these had, classes only saved what they changed from them
+	DisplayName_DEPRECATED = FText::FromString("Item");
+	UseActionText_DEPRECATED = FText::FromString("Use");
+	Rarity_DEPRECATED = ESIItemRarity::IR_Common;
+	Weight_DEPRECATED = 0.f;
+	bStackable_DEPRECATED = true;
+	MaxStackSize_DEPRECATED = 2;
+	Dimensions_DEPRECATED = FIntPoint::ZeroValue;
 }
 
 void USIItem::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -45,23 +55,150 @@ void USIItem::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent
 	FName ChangedPropertyName = PropertyChangedEvent.Property ? PropertyChangedEvent.Property->GetFName() : NAME_None;
 
 	// UPROPERTY clamping doesn't support using a variable to clamp so we do in here instead
-	if (ChangedPropertyName == GET_MEMBER_NAME_CHECKED(USIItem, Quantity))
+	if (ChangedPropertyName == GET_MEMBER_NAME_CHECKED(USIItem, Quantity) || ChangedPropertyName == GET_MEMBER_NAME_CHECKED(USIItem, Definition))
 	{
-		Quantity = FMath::Clamp(Quantity, 1, bStackable ? MaxStackSize : 1);
+		Quantity = FMath::Clamp(Quantity, 1, GetMaxStackSize());
 	}
-	else if (ChangedPropertyName == GET_MEMBER_NAME_CHECKED(USIItem, bStackable))
+}
+#endif
+
+void USIItem::PostLoad()
+{
+	Super::PostLoad();
+
+	// Not only in the editor, the cooker saves the migrated definition into the cooked package and uncooked standalone
+	// builds still have the old data to build it from
+	if (HasAnyFlags(RF_ClassDefaultObject) && !Definition)
 	{
-		if (!bStackable)
-		{
-			Quantity = 1;
-		}
+		MigrateDeprecatedDefinition();
 	}
 }
+
+void USIItem::MigrateDeprecatedDefinition()
+{
+	// Native classes have nothing saved, their definitions are assigned in their blueprints
+	UPackage* Package = GetOutermost();
+
+	if (!Package || GetClass()->HasAnyClassFlags(CLASS_Native) || Package->HasAnyPackageFlags(PKG_CompiledIn))
+	{
+		return;
+	}
+
+	const FName DefinitionName = MakeUniqueObjectName(Package, USIItemDefinition::StaticClass(), *FString::Printf(TEXT("%s_Definition"), *GetClass()->GetName().LeftChop(2)));
+
+	USIItemDefinition* NewDefinition = NewObject<USIItemDefinition>(Package, DefinitionName, RF_Public);
+	NewDefinition->Dimensions = FIntPoint(FMath::Max(Dimensions_DEPRECATED.X, 1), FMath::Max(Dimensions_DEPRECATED.Y, 1));
+	NewDefinition->Weight = Weight_DEPRECATED;
+	NewDefinition->MaxStackSize = MaxStackSize_DEPRECATED;
+	NewDefinition->bStackable = bStackable_DEPRECATED;
+	NewDefinition->Rarity = Rarity_DEPRECATED;
+	NewDefinition->DisplayName = DisplayName_DEPRECATED;
+	NewDefinition->Description = Description_DEPRECATED;
+	NewDefinition->UseActionText = UseActionText_DEPRECATED;
+	NewDefinition->PickupMesh = PickupMesh_DEPRECATED;
+	NewDefinition->Thumbnail = Thumbnail_DEPRECATED;
+	NewDefinition->ThumbnailRotated = ThumbnailRotated_DEPRECATED;
+	NewDefinition->ItemTooltip = ItemTooltip_DEPRECATED;
+
+	Definition = NewDefinition;
+
+	UE_LOG(LogTemp, Warning, TEXT("Moved the item data of %s into %s, resave the blueprint to keep it."), *GetClass()->GetName(), *DefinitionName.ToString());
+
+#if WITH_EDITOR
+	// Dirtying is ignored while the package is still loading, wait for the next tick so the editor asks to save it
+	if (GIsEditor && !IsRunningCommandlet())
+	{
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(Package, [Package](float)
+		{
+			Package->MarkPackageDirty();
+			return false;
+		}));
+	}
 #endif
+}
 
 float USIItem::GetStackWeight() const
 {
-	return Quantity * Weight;
+	return SIInventory::GetStackWeight(GetWeight(), Quantity);
+}
+
+float USIItem::GetUnitWeight() const
+{
+	return Quantity > 0 ? GetStackWeight() / Quantity : GetWeight();
+}
+
+UMaterialInterface* USIItem::GetThumbnail(const bool bCurrentRotated/* = true*/) const
+{
+	const bool bUseRotated = bCurrentRotated ? bRotated : bNewRotated;
+
+	// The rotated thumbnail is optional, the inventory grid rotates the regular one when it isn't set
+	const USIItemDefinition* ItemDefinition = GetDefinition();
+	const TSoftObjectPtr<UMaterialInterface>& ThumbnailRef = bUseRotated && !ItemDefinition->ThumbnailRotated.IsNull() ? ItemDefinition->ThumbnailRotated : ItemDefinition->Thumbnail;
+
+	if (ThumbnailRef.IsNull())
+	{
+		return nullptr;
+	}
+
+	// Thumbnails are streamed in when the inventory opens, this only blocks if that request hasn't finished yet
+	UMaterialInterface* LoadedThumbnail = ThumbnailRef.Get();
+
+	return LoadedThumbnail ? LoadedThumbnail : ThumbnailRef.LoadSynchronous();
+}
+
+TSharedPtr<FStreamableHandle> USIItem::RequestPickupMesh(FStreamableDelegate OnLoaded) const
+{
+	const TSoftObjectPtr<UStaticMesh>& PickupMesh = GetPickupMesh();
+
+	if (PickupMesh.IsNull())
+	{
+		OnLoaded.ExecuteIfBound();
+		return nullptr;
+	}
+
+	return UAssetManager::GetStreamableManager().RequestAsyncLoad(PickupMesh.ToSoftObjectPath(), OnLoaded);
+}
+
+TSharedPtr<FStreamableHandle> USIItem::RequestThumbnails(const TArray<USIItem*>& Items, FStreamableDelegate OnLoaded)
+{
+	TArray<FSoftObjectPath> ThumbnailPaths;
+
+	TSet<const USIItemDefinition*, DefaultKeyFuncs<const USIItemDefinition*>, TInlineSetAllocator<16>> Definitions;
+
+	// Items of the same kind share their definition, so each one is only looked at once
+	for (const USIItem* Item : Items)
+	{
+		if (Item)
+		{
+			bool bAlreadyInSet = false;
+			const USIItemDefinition* ItemDefinition = Item->GetDefinition();
+
+			Definitions.Add(ItemDefinition, &bAlreadyInSet);
+
+			if (bAlreadyInSet)
+			{
+				continue;
+			}
+
+			if (!ItemDefinition->Thumbnail.IsNull())
+			{
+				ThumbnailPaths.AddUnique(ItemDefinition->Thumbnail.ToSoftObjectPath());
+			}
+
+			if (!ItemDefinition->ThumbnailRotated.IsNull())
+			{
+				ThumbnailPaths.AddUnique(ItemDefinition->ThumbnailRotated.ToSoftObjectPath());
+			}
+		}
+	}
+
+	if (ThumbnailPaths.Num() == 0)
+	{
+		OnLoaded.ExecuteIfBound();
+		return nullptr;
+	}
+
+	return UAssetManager::GetStreamableManager().RequestAsyncLoad(ThumbnailPaths, OnLoaded);
 }
 
 void USIItem::MarkDirtyForReplication()
@@ -80,6 +217,10 @@ void USIItem::AddedToInventory(USIInventoryComponent* Inventory)
 {
 }
 
+void USIItem::CopyStateFrom(USIItem* Source)
+{
+}
+
 void USIItem::Rotate()
 {
 	bNewRotated = !bNewRotated;
@@ -103,18 +244,28 @@ void USIItem::SetRotated(const bool bValue)
 void USIItem::OnRep_Rotated()
 {
 	OnItemModified.Broadcast();
+
+	if (OwningInventory)
+	{
+		OwningInventory->NotifyItemRotated(this);
+	}
 }
 
 void USIItem::OnRep_NewRotated()
 {
 	OnItemModified.Broadcast();
+
+	if (OwningInventory)
+	{
+		OwningInventory->NotifyItemRotated(this);
+	}
 }
 
 void USIItem::SetQuantity(const int32 NewQuantity)
 {
 	if (NewQuantity != Quantity)
 	{
-		Quantity = FMath::Clamp(NewQuantity, 0, bStackable ? MaxStackSize : 1);
+		Quantity = FMath::Clamp(NewQuantity, 0, GetMaxStackSize());
 		OnRep_Quantity();
 		
 		MarkDirtyForReplication();
@@ -124,6 +275,11 @@ void USIItem::SetQuantity(const int32 NewQuantity)
 void USIItem::OnRep_Quantity()
 {
 	OnItemModified.Broadcast();
+
+	if (OwningInventory)
+	{
+		OwningInventory->NotifyItemQuantityChanged(this);
+	}
 }
 
 void USIItem::SetOwner(AActor* NewOwner)
@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/SIItemDefinition.h"
+
+USIItemDefinition::USIItemDefinition()
+{
+	Dimensions = FIntPoint(1, 1);
+	Weight = 0.f;
+	MaxStackSize = 2;
+	bStackable = true;
+	Rarity = ESIItemRarity::IR_Common;
+	DisplayName = FText::FromString("Item");
+	UseActionText = FText::FromString("Use");
+}
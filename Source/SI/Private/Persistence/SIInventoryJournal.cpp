@@ -0,0 +1,566 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Persistence/SIInventoryJournal.h"
+
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace SIInventoryJournal
+{
+	//"SIIJ"
+	static constexpr uint32 Magic = 0x4A494953;
+	static constexpr uint16 Version = 1;
+
+	static const TCHAR* FilePrefix = TEXT("Journal_");
+	static const TCHAR* FileExtension = TEXT(".bin");
+
+	static void SerializePacked(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = static_cast<uint32>(Value);
+		Ar.SerializeIntPacked(Packed);
+		Value = static_cast<int32>(Packed);
+	}
+
+	//Replays changes onto the snapshots of one journal file
+	struct FReplayState
+	{
+		TMap<int32, FString> Keys;
+		TMap<int32, FString> Types;
+
+		TMap<FString, FSIInventorySnapshot> Snapshots;
+
+		FSIInventorySnapshotItem* FindItem(FSIInventorySnapshot& Snapshot, const int32 Anchor)
+		{
+			return Snapshot.Items.FindByPredicate([Anchor](const FSIInventorySnapshotItem& Item) { return Item.Anchor == Anchor; });
+		}
+
+		//Changes to an inventory before its snapshot in the checkpoint are already part of that snapshot
+		FSIInventorySnapshot* FindSnapshot(const int32 KeyId)
+		{
+			const FString* Key = Keys.Find(KeyId);
+			return Key ? Snapshots.Find(*Key) : nullptr;
+		}
+
+		void Apply(const FSIInventoryJournalEntry& Entry)
+		{
+			FSIInventorySnapshot* Snapshot = FindSnapshot(Entry.KeyId);
+
+			if (!Snapshot)
+			{
+				return;
+			}
+
+			switch (Entry.Op)
+			{
+			case ESIInventoryJournalOp::Add:
+			{
+				const FString* Type = Types.Find(Entry.TypeId);
+
+				if (Type)
+				{
+					FSIInventorySnapshotItem& Item = Snapshot->Items.AddDefaulted_GetRef();
+					Item.TypeId = Snapshot->ItemTypes.AddUnique(*Type);
+					Item.Anchor = Entry.Anchor;
+					Item.Quantity = Entry.Quantity;
+					Item.bRotated = Entry.bRotated;
+				}
+
+				break;
+			}
+			case ESIInventoryJournalOp::Remove:
+				Snapshot->Items.RemoveAll([&Entry](const FSIInventorySnapshotItem& Item) { return Item.Anchor == Entry.Anchor; });
+				break;
+
+			case ESIInventoryJournalOp::Quantity:
+				if (Entry.Quantity <= 0)
+				{
+					Snapshot->Items.RemoveAll([&Entry](const FSIInventorySnapshotItem& Item) { return Item.Anchor == Entry.Anchor; });
+				}
+				else if (FSIInventorySnapshotItem* Item = FindItem(*Snapshot, Entry.Anchor))
+				{
+					Item->Quantity = Entry.Quantity;
+				}
+
+				break;
+
+			case ESIInventoryJournalOp::Rotate:
+				if (FSIInventorySnapshotItem* Item = FindItem(*Snapshot, Entry.Anchor))
+				{
+					Item->bRotated = Entry.bRotated;
+				}
+
+				break;
+
+			default:
+				break;
+			}
+		}
+	};
+
+	//False when the file ends before its checkpoint is complete. Changes after it stop at the first damaged record
+	static bool ReplayFile(const FString& Filename, TMap<FString, FSIInventorySnapshot>& OutSnapshots)
+	{
+		TArray<uint8> Bytes;
+
+		if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+		{
+			return false;
+		}
+
+		FMemoryReader Reader(Bytes);
+
+		// No name or snapshot in there can be longer than the file, a damaged length ends the replay instead of allocating it
+		Reader.ArMaxSerializeSize = Bytes.Num();
+
+		uint32 FileMagic = 0;
+		uint16 FileVersion = 0;
+
+		Reader << FileMagic;
+		Reader << FileVersion;
+
+		if (Reader.IsError() || FileMagic != Magic || FileVersion != Version)
+		{
+			return false;
+		}
+
+		FReplayState State;
+		bool bCheckpointComplete = false;
+
+		while (!Reader.AtEnd())
+		{
+			uint8 Op = 0;
+			Reader << Op;
+
+			FSIInventoryJournalEntry Entry;
+			Entry.Op = static_cast<ESIInventoryJournalOp>(Op);
+
+			switch (Entry.Op)
+			{
+			case ESIInventoryJournalOp::DefineKey:
+			case ESIInventoryJournalOp::DefineType:
+			{
+				int32 Id = 0;
+				FString Name;
+
+				SerializePacked(Reader, Id);
+				Reader << Name;
+
+				if (!Reader.IsError())
+				{
+					(Entry.Op == ESIInventoryJournalOp::DefineKey ? State.Keys : State.Types).Add(Id, MoveTemp(Name));
+				}
+
+				break;
+			}
+			case ESIInventoryJournalOp::Snapshot:
+			{
+				int32 KeyId = 0;
+				TArray<uint8> SnapshotBytes;
+
+				SerializePacked(Reader, KeyId);
+				Reader << SnapshotBytes;
+
+				const FString* Key = State.Keys.Find(KeyId);
+				FSIInventorySnapshot Snapshot;
+
+				if (!Reader.IsError() && Key && FSIInventorySnapshot::Deserialize(SnapshotBytes, Snapshot))
+				{
+					State.Snapshots.Add(*Key, MoveTemp(Snapshot));
+				}
+
+				break;
+			}
+			case ESIInventoryJournalOp::CheckpointEnd:
+				bCheckpointComplete = true;
+				break;
+
+			case ESIInventoryJournalOp::Add:
+			case ESIInventoryJournalOp::Remove:
+			case ESIInventoryJournalOp::Quantity:
+			case ESIInventoryJournalOp::Rotate:
+			{
+				uint8 bRotated = 0;
+
+				SerializePacked(Reader, Entry.KeyId);
+				SerializePacked(Reader, Entry.Anchor);
+
+				if (Entry.Op == ESIInventoryJournalOp::Add)
+				{
+					SerializePacked(Reader, Entry.TypeId);
+				}
+
+				if (Entry.Op == ESIInventoryJournalOp::Add || Entry.Op == ESIInventoryJournalOp::Quantity)
+				{
+					SerializePacked(Reader, Entry.Quantity);
+				}
+
+				if (Entry.Op == ESIInventoryJournalOp::Add || Entry.Op == ESIInventoryJournalOp::Rotate)
+				{
+					Reader << bRotated;
+					Entry.bRotated = bRotated != 0;
+				}
+
+				// A record cut short by the crash is the end of the journal
+				if (!Reader.IsError())
+				{
+					State.Apply(Entry);
+				}
+
+				break;
+			}
+			default:
+				Reader.SetError();
+				break;
+			}
+
+			if (Reader.IsError())
+			{
+				break;
+			}
+		}
+
+		if (bCheckpointComplete)
+		{
+			OutSnapshots = MoveTemp(State.Snapshots);
+		}
+
+		return bCheckpointComplete;
+	}
+}
+
+FSIInventoryJournalWriter::FSIInventoryJournalWriter(const FString& InDirectory)
+	: Directory(InDirectory)
+	, bStopping(false)
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FSIInventoryJournalWriter::~FSIInventoryJournalWriter()
+{
+	Shutdown();
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+bool FSIInventoryJournalWriter::Start()
+{
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	// Carry on numbering from the files already there, recovery has read them by now
+	TArray<TPair<int32, FString>> Files;
+	ListJournalFiles(Directory, Files);
+
+	FileNumber = Files.Num() > 0 ? Files.Last().Key : 0;
+
+	if (!Thread)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("SIInventoryJournal"), 0, TPri_BelowNormal);
+	}
+
+	return Thread != nullptr;
+}
+
+void FSIInventoryJournalWriter::Shutdown()
+{
+	if (Thread)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FSIInventoryJournalWriter::EnqueueBatch(FSIInventoryJournalBatch&& Batch)
+{
+	PendingBatches.Enqueue(MoveTemp(Batch));
+	WakeEvent->Trigger();
+}
+
+uint32 FSIInventoryJournalWriter::Run()
+{
+	while (!bStopping)
+	{
+		WakeEvent->Wait();
+		ProcessBatches();
+	}
+
+	ProcessBatches();
+
+	return 0;
+}
+
+void FSIInventoryJournalWriter::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+void FSIInventoryJournalWriter::Exit()
+{
+	if (File)
+	{
+		File->Close();
+		delete File;
+		File = nullptr;
+	}
+
+	// A checkpoint left unfinished is skipped by recovery, the previous file still has everything
+	if (CheckpointFile)
+	{
+		CheckpointFile->Close();
+		delete CheckpointFile;
+		CheckpointFile = nullptr;
+	}
+}
+
+void FSIInventoryJournalWriter::ProcessBatches()
+{
+	FSIInventoryJournalBatch Batch;
+
+	while (PendingBatches.Dequeue(Batch))
+	{
+		for (TPair<int32, FString>& NewKey : Batch.NewKeys)
+		{
+			Keys.Add(NewKey.Key, NewKey.Value);
+		}
+
+		for (TPair<int32, FString>& NewType : Batch.NewTypes)
+		{
+			Types.Add(NewType.Key, NewType.Value);
+		}
+
+		if (Batch.bCheckpointStart && !CheckpointFile)
+		{
+			BeginCheckpointFile();
+		}
+
+		// Changes only mean something after a checkpoint, the first batch always starts one
+		if (File || CheckpointFile)
+		{
+			Buffer.Reset();
+			FMemoryWriter Writer(Buffer);
+
+			for (const TPair<int32, FString>& NewKey : Batch.NewKeys)
+			{
+				WriteDefine(Writer, ESIInventoryJournalOp::DefineKey, NewKey.Key, NewKey.Value);
+			}
+
+			for (const TPair<int32, FString>& NewType : Batch.NewTypes)
+			{
+				WriteDefine(Writer, ESIInventoryJournalOp::DefineType, NewType.Key, NewType.Value);
+			}
+
+			int32 SnapshotIndex = 0;
+
+			for (const FSIInventoryJournalEntry& Entry : Batch.Entries)
+			{
+				if (Entry.Op == ESIInventoryJournalOp::Snapshot)
+				{
+					if (Batch.Snapshots.IsValidIndex(SnapshotIndex))
+					{
+						WriteSnapshot(Writer, Batch.Snapshots[SnapshotIndex].Key, Batch.Snapshots[SnapshotIndex].Value);
+					}
+
+					SnapshotIndex++;
+				}
+				else
+				{
+					WriteEntry(Writer, Entry);
+				}
+			}
+
+			if (File)
+			{
+				File->Serialize(Buffer.GetData(), Buffer.Num());
+				File->Flush();
+			}
+
+			if (CheckpointFile)
+			{
+				CheckpointFile->Serialize(Buffer.GetData(), Buffer.Num());
+			}
+		}
+
+		if (CheckpointFile)
+		{
+			Buffer.Reset();
+			FMemoryWriter Writer(Buffer);
+
+			for (const TPair<int32, FSIInventorySnapshot>& Snapshot : Batch.Checkpoint)
+			{
+				WriteSnapshot(Writer, Snapshot.Key, Snapshot.Value);
+			}
+
+			CheckpointFile->Serialize(Buffer.GetData(), Buffer.Num());
+			CheckpointFile->Flush();
+
+			if (Batch.bCheckpointEnd)
+			{
+				EndCheckpointFile();
+			}
+		}
+	}
+}
+
+void FSIInventoryJournalWriter::WriteEntry(FArchive& Ar, const FSIInventoryJournalEntry& Entry)
+{
+	uint8 Op = static_cast<uint8>(Entry.Op);
+	int32 KeyId = Entry.KeyId;
+	int32 Anchor = Entry.Anchor;
+	int32 TypeId = Entry.TypeId;
+	int32 Quantity = Entry.Quantity;
+	uint8 bRotated = Entry.bRotated ? 1 : 0;
+
+	Ar << Op;
+	SIInventoryJournal::SerializePacked(Ar, KeyId);
+	SIInventoryJournal::SerializePacked(Ar, Anchor);
+
+	if (Entry.Op == ESIInventoryJournalOp::Add)
+	{
+		SIInventoryJournal::SerializePacked(Ar, TypeId);
+	}
+
+	if (Entry.Op == ESIInventoryJournalOp::Add || Entry.Op == ESIInventoryJournalOp::Quantity)
+	{
+		SIInventoryJournal::SerializePacked(Ar, Quantity);
+	}
+
+	if (Entry.Op == ESIInventoryJournalOp::Add || Entry.Op == ESIInventoryJournalOp::Rotate)
+	{
+		Ar << bRotated;
+	}
+}
+
+void FSIInventoryJournalWriter::WriteDefine(FArchive& Ar, const ESIInventoryJournalOp Op, int32 Id, FString Name)
+{
+	uint8 OpByte = static_cast<uint8>(Op);
+
+	Ar << OpByte;
+	SIInventoryJournal::SerializePacked(Ar, Id);
+	Ar << Name;
+}
+
+void FSIInventoryJournalWriter::WriteSnapshot(FArchive& Ar, int32 KeyId, const FSIInventorySnapshot& Snapshot)
+{
+	uint8 Op = static_cast<uint8>(ESIInventoryJournalOp::Snapshot);
+
+	SnapshotBuffer.Reset();
+	Snapshot.Serialize(SnapshotBuffer);
+
+	Ar << Op;
+	SIInventoryJournal::SerializePacked(Ar, KeyId);
+	Ar << SnapshotBuffer;
+}
+
+void FSIInventoryJournalWriter::BeginCheckpointFile()
+{
+	const FString Filename = FPaths::Combine(Directory, FString::Printf(TEXT("%s%08d%s"), SIInventoryJournal::FilePrefix, FileNumber + 1, SIInventoryJournal::FileExtension));
+
+	CheckpointFile = IFileManager::Get().CreateFileWriter(*Filename);
+
+	if (!CheckpointFile)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't create the inventory journal %s, changes keep going to the previous one."), *Filename);
+		return;
+	}
+
+	FileNumber++;
+
+	Buffer.Reset();
+	FMemoryWriter Writer(Buffer);
+
+	uint32 Magic = SIInventoryJournal::Magic;
+	uint16 Version = SIInventoryJournal::Version;
+
+	Writer << Magic;
+	Writer << Version;
+
+	for (const TPair<int32, FString>& Key : Keys)
+	{
+		WriteDefine(Writer, ESIInventoryJournalOp::DefineKey, Key.Key, Key.Value);
+	}
+
+	for (const TPair<int32, FString>& Type : Types)
+	{
+		WriteDefine(Writer, ESIInventoryJournalOp::DefineType, Type.Key, Type.Value);
+	}
+
+	CheckpointFile->Serialize(Buffer.GetData(), Buffer.Num());
+}
+
+void FSIInventoryJournalWriter::EndCheckpointFile()
+{
+	uint8 EndOp = static_cast<uint8>(ESIInventoryJournalOp::CheckpointEnd);
+
+	*CheckpointFile << EndOp;
+	CheckpointFile->Flush();
+
+	if (File)
+	{
+		File->Close();
+		delete File;
+	}
+
+	File = CheckpointFile;
+	CheckpointFile = nullptr;
+
+	// The new checkpoint covers everything in the older files
+	TArray<TPair<int32, FString>> Files;
+	ListJournalFiles(Directory, Files);
+
+	for (const TPair<int32, FString>& OldFile : Files)
+	{
+		if (OldFile.Key < FileNumber)
+		{
+			IFileManager::Get().Delete(*OldFile.Value);
+		}
+	}
+}
+
+void FSIInventoryJournalWriter::ListJournalFiles(const FString& Directory, TArray<TPair<int32, FString>>& OutFiles)
+{
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFiles(Filenames, *FPaths::Combine(Directory, FString(SIInventoryJournal::FilePrefix) + TEXT("*") + SIInventoryJournal::FileExtension), true, false);
+
+	for (const FString& Filename : Filenames)
+	{
+		const FString Number = FPaths::GetBaseFilename(Filename).RightChop(FCString::Strlen(SIInventoryJournal::FilePrefix));
+
+		if (Number.IsNumeric())
+		{
+			OutFiles.Emplace(FCString::Atoi(*Number), FPaths::Combine(Directory, Filename));
+		}
+	}
+
+	OutFiles.Sort([](const TPair<int32, FString>& A, const TPair<int32, FString>& B)
+	{
+		return A.Key < B.Key;
+	});
+}
+
+bool FSIInventoryJournalWriter::Recover(const FString& Directory, TMap<FString, FSIInventorySnapshot>& OutSnapshots)
+{
+	TArray<TPair<int32, FString>> Files;
+	ListJournalFiles(Directory, Files);
+
+	// The newest file can be one whose checkpoint was still being written, then the one before it has everything
+	for (int32 Index = Files.Num() - 1; Index >= 0; Index--)
+	{
+		if (SIInventoryJournal::ReplayFile(Files[Index].Value, OutSnapshots))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
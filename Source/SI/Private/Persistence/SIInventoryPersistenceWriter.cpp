@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Persistence/SIInventoryPersistenceWriter.h"
+
+#include "Async/Async.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Crc.h"
+#include "Persistence/SIInventoryPersistenceBackend.h"
+
+FSIInventoryPersistenceWriter::FSIInventoryPersistenceWriter(TUniquePtr<ISIInventoryPersistenceBackend> InBackend)
+	: Backend(MoveTemp(InBackend))
+	, bStopping(false)
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FSIInventoryPersistenceWriter::~FSIInventoryPersistenceWriter()
+{
+	Shutdown();
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+bool FSIInventoryPersistenceWriter::Start()
+{
+	// Opened here rather than on the thread, so a backend that can't open fails the start instead of piling up writes
+	if (!Thread && Backend && Backend->Open())
+	{
+		Thread = FRunnableThread::Create(this, TEXT("SIInventoryPersistence"), 0, TPri_BelowNormal);
+
+		if (!Thread)
+		{
+			Backend->Close();
+		}
+	}
+
+	return Thread != nullptr;
+}
+
+void FSIInventoryPersistenceWriter::Shutdown()
+{
+	if (Thread)
+	{
+		// Run writes whatever is left in the queues once it sees the stop
+		Stop();
+		Thread->WaitForCompletion();
+
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FSIInventoryPersistenceWriter::EnqueueWrite(const FString& Key, FSIInventorySnapshot&& Snapshot)
+{
+	PendingWrites.Enqueue({ Key, MoveTemp(Snapshot) });
+}
+
+void FSIInventoryPersistenceWriter::EnqueueRead(const FString& Key, TFunction<void(TOptional<FSIInventorySnapshot>)> OnRead)
+{
+	PendingReads.Enqueue({ Key, MoveTemp(OnRead) });
+	WakeEvent->Trigger();
+}
+
+void FSIInventoryPersistenceWriter::Flush()
+{
+	WakeEvent->Trigger();
+}
+
+uint32 FSIInventoryPersistenceWriter::Run()
+{
+	while (!bStopping)
+	{
+		WakeEvent->Wait();
+		ProcessQueues();
+	}
+
+	// Clean flush of what was queued right before the stop
+	ProcessQueues();
+
+	return 0;
+}
+
+void FSIInventoryPersistenceWriter::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+void FSIInventoryPersistenceWriter::Exit()
+{
+	if (Backend)
+	{
+		Backend->Close();
+	}
+}
+
+void FSIInventoryPersistenceWriter::ProcessQueues()
+{
+	// An inventory saved several times since the last batch only needs its latest snapshot written
+	TMap<FString, FSIInventorySnapshot> LatestSnapshots;
+	FPendingWrite PendingWrite;
+
+	while (PendingWrites.Dequeue(PendingWrite))
+	{
+		LatestSnapshots.Add(MoveTemp(PendingWrite.Key), MoveTemp(PendingWrite.Snapshot));
+	}
+
+	TArray<FSIInventoryRecord> Records;
+	TArray<uint32, TInlineAllocator<64>> RecordHashes;
+
+	for (TPair<FString, FSIInventorySnapshot>& LatestSnapshot : LatestSnapshots)
+	{
+		FSIInventoryRecord Record;
+		Record.Key = LatestSnapshot.Key;
+		LatestSnapshot.Value.Serialize(Record.Data);
+
+		// Back to how it was when it was last written, nothing to do
+		const uint32 Hash = FCrc::MemCrc32(Record.Data.GetData(), Record.Data.Num());
+		const uint32* WrittenHash = WrittenHashes.Find(Record.Key);
+
+		if (WrittenHash && *WrittenHash == Hash)
+		{
+			continue;
+		}
+
+		Records.Add(MoveTemp(Record));
+		RecordHashes.Add(Hash);
+	}
+
+	// What the last batch failed to write goes again, unless a newer snapshot of it came in
+	for (TPair<FString, FSIInventoryRecord>& UnwrittenRecord : UnwrittenRecords)
+	{
+		if (!LatestSnapshots.Contains(UnwrittenRecord.Key))
+		{
+			RecordHashes.Add(FCrc::MemCrc32(UnwrittenRecord.Value.Data.GetData(), UnwrittenRecord.Value.Data.Num()));
+			Records.Add(MoveTemp(UnwrittenRecord.Value));
+		}
+	}
+
+	UnwrittenRecords.Reset();
+
+	if (Records.Num() > 0)
+	{
+		if (Backend->WriteBatch(Records))
+		{
+			for (int32 Index = 0; Index < Records.Num(); Index++)
+			{
+				WrittenHashes.Add(Records[Index].Key, RecordHashes[Index]);
+			}
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Couldn't write a batch of %d inventories, retrying with the next one."), Records.Num());
+
+			for (FSIInventoryRecord& Record : Records)
+			{
+				const FString Key = Record.Key;
+				UnwrittenRecords.Add(Key, MoveTemp(Record));
+			}
+		}
+	}
+
+	FPendingRead PendingRead;
+
+	while (PendingReads.Dequeue(PendingRead))
+	{
+		TOptional<FSIInventorySnapshot> Result;
+		TArray<uint8> Data;
+		FSIInventorySnapshot Snapshot;
+
+		if (Backend->Read(PendingRead.Key, Data) && FSIInventorySnapshot::Deserialize(Data, Snapshot))
+		{
+			WrittenHashes.Add(PendingRead.Key, FCrc::MemCrc32(Data.GetData(), Data.Num()));
+			Result = MoveTemp(Snapshot);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [OnRead = MoveTemp(PendingRead.OnRead), Result = MoveTemp(Result)]() mutable
+		{
+			if (OnRead)
+			{
+				OnRead(MoveTemp(Result));
+			}
+		});
+	}
+}
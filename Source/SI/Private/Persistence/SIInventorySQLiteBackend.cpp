@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Persistence/SIInventorySQLiteBackend.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "SQLiteDatabase.h"
+#include "SQLitePreparedStatement.h"
+
+FSIInventorySQLiteBackend::FSIInventorySQLiteBackend(const FString& InFilename)
+	: Filename(InFilename)
+{
+}
+
+FSIInventorySQLiteBackend::~FSIInventorySQLiteBackend()
+{
+	Close();
+}
+
+bool FSIInventorySQLiteBackend::Open()
+{
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+
+	Database = MakeUnique<FSQLiteDatabase>();
+
+	if (!Database->Open(*Filename, ESQLiteDatabaseOpenMode::ReadWriteCreate))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't open the inventory database %s: %s"), *Filename, *Database->GetLastError());
+		Close();
+		return false;
+	}
+
+	// Writes come in batches from a single thread, the write-ahead log lets them land without blocking readers
+	if (!Database->Execute(TEXT("PRAGMA journal_mode=WAL;")) || !Database->Execute(TEXT("PRAGMA synchronous=NORMAL;")))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't set up the inventory database %s: %s"), *Filename, *Database->GetLastError());
+		Close();
+		return false;
+	}
+
+	if (!Database->Execute(TEXT("CREATE TABLE IF NOT EXISTS inventories (key TEXT PRIMARY KEY NOT NULL, data BLOB NOT NULL, updated INTEGER NOT NULL);")))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't create the inventory table in %s: %s"), *Filename, *Database->GetLastError());
+		Close();
+		return false;
+	}
+
+	WriteStatement = MakeUnique<FSQLitePreparedStatement>(Database->PrepareStatement(TEXT("INSERT OR REPLACE INTO inventories (key, data, updated) VALUES (?1, ?2, ?3);"), ESQLitePreparedStatementFlags::Persistent));
+	ReadStatement = MakeUnique<FSQLitePreparedStatement>(Database->PrepareStatement(TEXT("SELECT data FROM inventories WHERE key = ?1;"), ESQLitePreparedStatementFlags::Persistent));
+
+	if (!WriteStatement->IsValid() || !ReadStatement->IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't prepare the inventory statements for %s: %s"), *Filename, *Database->GetLastError());
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void FSIInventorySQLiteBackend::Close()
+{
+	// Statements have to be finalized before the database they belong to
+	WriteStatement.Reset();
+	ReadStatement.Reset();
+
+	// Also reached from a failed open, closing a handle that never opened is a no-op
+	if (Database)
+	{
+		if (Database->IsValid())
+		{
+			Database->Close();
+		}
+
+		Database.Reset();
+	}
+}
+
+bool FSIInventorySQLiteBackend::WriteBatch(const TArray<FSIInventoryRecord>& Records)
+{
+	if (!Database || !WriteStatement)
+	{
+		return false;
+	}
+
+	const int64 Now = FDateTime::UtcNow().ToUnixTimestamp();
+
+	// One transaction for the whole batch, so it costs a single sync to disk
+	Database->Execute(TEXT("BEGIN;"));
+
+	for (const FSIInventoryRecord& Record : Records)
+	{
+		WriteStatement->Reset();
+		WriteStatement->ClearBindings();
+		WriteStatement->SetBindingValueByIndex(1, Record.Key);
+		WriteStatement->SetBindingValueByIndex(2, TArrayView<const uint8>(Record.Data));
+		WriteStatement->SetBindingValueByIndex(3, Now);
+
+		if (!WriteStatement->Execute())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Couldn't write inventory %s: %s"), *Record.Key, *Database->GetLastError());
+			Database->Execute(TEXT("ROLLBACK;"));
+			return false;
+		}
+	}
+
+	return Database->Execute(TEXT("COMMIT;"));
+}
+
+bool FSIInventorySQLiteBackend::Read(const FString& Key, TArray<uint8>& OutData)
+{
+	if (!Database || !ReadStatement)
+	{
+		return false;
+	}
+
+	ReadStatement->Reset();
+	ReadStatement->ClearBindings();
+	ReadStatement->SetBindingValueByIndex(1, Key);
+
+	return ReadStatement->Step() == ESQLitePreparedStatementStepResult::Row && ReadStatement->GetColumnValueByIndex(0, OutData);
+}
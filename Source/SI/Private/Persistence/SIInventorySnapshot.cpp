@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Persistence/SIInventorySnapshot.h"
+
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace SIInventorySnapshot
+{
+	//"SIIV"
+	static constexpr uint32 Magic = 0x56494953;
+
+	//Containers inside containers inside containers... Corrupt data shouldn't be able to recurse forever
+	static constexpr int32 MaxDepth = 8;
+
+	static void SerializePacked(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = static_cast<uint32>(Value);
+		Ar.SerializeIntPacked(Packed);
+		Value = static_cast<int32>(Packed);
+	}
+
+	//Reads a count, refusing ones that couldn't possibly fit in what is left of the data
+	static bool SerializeCount(FArchive& Ar, int32& Count)
+	{
+		SerializePacked(Ar, Count);
+
+		return !Ar.IsError() && Count >= 0 && (!Ar.IsLoading() || Count <= Ar.TotalSize() - Ar.Tell());
+	}
+}
+
+void FSIInventorySnapshot::Serialize(TArray<uint8>& OutBytes) const
+{
+	FMemoryWriter Writer(OutBytes);
+
+	uint32 Magic = SIInventorySnapshot::Magic;
+	uint16 Version = static_cast<uint16>(ESIInventorySnapshotVersion::Latest);
+
+	Writer << Magic;
+	Writer << Version;
+
+	// Writing doesn't change anything, the body is shared with reading
+	const_cast<FSIInventorySnapshot*>(this)->SerializeBody(Writer, 0);
+}
+
+bool FSIInventorySnapshot::Deserialize(const TArray<uint8>& Bytes, FSIInventorySnapshot& OutSnapshot)
+{
+	FMemoryReader Reader(Bytes);
+
+	// No string or array in there can be longer than the data itself, refuse corrupt lengths before allocating them
+	Reader.ArMaxSerializeSize = Bytes.Num();
+
+	uint32 Magic = 0;
+	uint16 Version = 0;
+
+	Reader << Magic;
+	Reader << Version;
+
+	if (Reader.IsError() || Magic != SIInventorySnapshot::Magic || Version == 0 || Version > static_cast<uint16>(ESIInventorySnapshotVersion::Latest))
+	{
+		return false;
+	}
+
+	OutSnapshot = FSIInventorySnapshot();
+	OutSnapshot.SerializeBody(Reader, 0);
+
+	return !Reader.IsError();
+}
+
+void FSIInventorySnapshot::SerializeBody(FArchive& Ar, const int32 Depth)
+{
+	if (Depth > SIInventorySnapshot::MaxDepth)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	SIInventorySnapshot::SerializePacked(Ar, Rows);
+	SIInventorySnapshot::SerializePacked(Ar, Columns);
+
+	if (Ar.IsError() || Rows < 0 || Columns < 0)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	int32 NumTypes = ItemTypes.Num();
+
+	if (!SIInventorySnapshot::SerializeCount(Ar, NumTypes))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	ItemTypes.SetNum(NumTypes);
+
+	for (FString& ItemType : ItemTypes)
+	{
+		Ar << ItemType;
+
+		if (Ar.IsError())
+		{
+			return;
+		}
+	}
+
+	int32 NumItems = Items.Num();
+
+	if (!SIInventorySnapshot::SerializeCount(Ar, NumItems))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Items.SetNum(NumItems);
+
+	// Anchors are written as the distance from the previous one, items are in grid order so these stay small
+	int32 PreviousAnchor = 0;
+
+	for (FSIInventorySnapshotItem& Item : Items)
+	{
+		int32 AnchorDelta = Item.Anchor - PreviousAnchor;
+
+		uint8 Flags = (Item.bRotated ? 1 : 0) | (Item.InnerInventory != INDEX_NONE ? 2 : 0);
+
+		SIInventorySnapshot::SerializePacked(Ar, Item.TypeId);
+		SIInventorySnapshot::SerializePacked(Ar, Item.Quantity);
+		SIInventorySnapshot::SerializePacked(Ar, AnchorDelta);
+		Ar << Flags;
+
+		if (Flags & 2)
+		{
+			SIInventorySnapshot::SerializePacked(Ar, Item.InnerInventory);
+		}
+
+		if (Ar.IsError())
+		{
+			return;
+		}
+
+		if (Ar.IsLoading())
+		{
+			Item.Anchor = PreviousAnchor + AnchorDelta;
+			Item.bRotated = (Flags & 1) != 0;
+			Item.InnerInventory = (Flags & 2) ? Item.InnerInventory : INDEX_NONE;
+
+			if (!ItemTypes.IsValidIndex(Item.TypeId))
+			{
+				Ar.SetError();
+				return;
+			}
+		}
+
+		PreviousAnchor = Item.Anchor;
+	}
+
+	int32 NumInnerInventories = InnerInventories.Num();
+
+	if (!SIInventorySnapshot::SerializeCount(Ar, NumInnerInventories))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	InnerInventories.SetNum(NumInnerInventories);
+
+	for (FSIInventorySnapshot& InnerInventory : InnerInventories)
+	{
+		InnerInventory.SerializeBody(Ar, Depth + 1);
+
+		if (Ar.IsError())
+		{
+			return;
+		}
+	}
+}
+
+TFuture<TArray<uint8>> FSIInventorySnapshot::SerializeAsync(FSIInventorySnapshot&& Snapshot)
+{
+	return Async(EAsyncExecution::ThreadPool, [Snapshot = MoveTemp(Snapshot)]()
+	{
+		TArray<uint8> Bytes;
+		Snapshot.Serialize(Bytes);
+
+		return Bytes;
+	});
+}
+
+TFuture<bool> FSIInventorySnapshot::SaveToFileAsync(FSIInventorySnapshot&& Snapshot, const FString& Filename)
+{
+	return Async(EAsyncExecution::ThreadPool, [Snapshot = MoveTemp(Snapshot), Filename]()
+	{
+		TArray<uint8> Bytes;
+		Snapshot.Serialize(Bytes);
+
+		return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+	});
+}
+
+TFuture<TOptional<FSIInventorySnapshot>> FSIInventorySnapshot::LoadFromFileAsync(const FString& Filename)
+{
+	return Async(EAsyncExecution::ThreadPool, [Filename]()
+	{
+		TOptional<FSIInventorySnapshot> Result;
+		TArray<uint8> Bytes;
+		FSIInventorySnapshot Snapshot;
+
+		if (FFileHelper::LoadFileToArray(Bytes, *Filename) && Deserialize(Bytes, Snapshot))
+		{
+			Result = MoveTemp(Snapshot);
+		}
+
+		return Result;
+	});
+}
@@ -3,14 +3,17 @@
 #include "Player/SICharacter.h"
 
 #include "SI.h"
+#include "Algo/BinarySearch.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "Components/SIInteractionComponent.h"
 #include "Components/SIInventoryComponent.h"
+#include "Framework/SIInteractionSubsystem.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "Items/SIContainerItem.h"
 #include "Items/SIItem.h"
 #include "Net/UnrealNetwork.h"
 #include "Player/SIPlayerController.h"
@@ -63,13 +66,38 @@ ASICharacter::ASICharacter()
 	InventoryComponent = CreateDefaultSubobject<USIInventoryComponent>(TEXT("InventoryComponent"));
 	InventoryComponent->Rows = 15;
 	InventoryComponent->Columns = 6;
+	bCanOpenOtherPawnsContainers = false;
 
 	// Interaction
-	InteractionCheckFrequency = 0.f;
+	InteractionCheckFrequency = 0.1f;
 	InteractionCheckDistance = 1000.f;
+	InteractionValidationTolerance = 150.f;
+	InteractionValidationHalfAngle = 45.f;
+	bValidateInteractionWithTrace = false;
+	InteractionSelectionMode = ESIInteractionSelectionMode::ISM_LineTrace;
+	InteractionCandidateBudget = 16;
+	InteractionCandidateHalfAngle = 30.f;
+	InteractionAngleWeight = 1.f;
+	InteractionDistanceWeight = 0.5f;
 	bCanInteract = true;
 }
 
+void ASICharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Pockets, rigs and the like added in blueprint join the main inventory. Container grids join once the container is put in one of them
+	TInlineComponentArray<USIInventoryComponent*> Inventories(this);
+
+	for (USIInventoryComponent* Inventory : Inventories)
+	{
+		if (!Inventory->OwnerContainer)
+		{
+			AddInventory(Inventory);
+		}
+	}
+}
+
 void ASICharacter::Restart()
 {
 	Super::Restart();
@@ -87,10 +115,15 @@ void ASICharacter::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	// Interaction
-	if (GetWorld()->TimeSince(InteractionData.LastInteractionCheckTime) > InteractionCheckFrequency)
+	// Interaction. Only the locally controlled character looks for interactables, the server validates when an interact is requested
+	if (IsLocallyControlled())
 	{
-		PerformInteractionCheck();
+		ConsumeInteractionCheck();
+
+		if (!InteractionTraceHandle.IsValid() && GetWorld()->TimeSince(InteractionData.LastInteractionCheckTime) > InteractionCheckFrequency)
+		{
+			RequestInteractionCheck();
+		}
 	}
 }
 
@@ -138,65 +171,53 @@ void ASICharacter::LootItem(USIItem* ItemToGive, USIInventoryComponent* TargetIn
 {
 	if (HasAuthority())
 	{
-		USIInventoryComponent* ItemInventorySource = ItemToGive->OwningInventory;
-		
-		if (ItemToGive && ItemInventorySource)
+		USIInventoryComponent* ItemInventorySource = ItemToGive ? ItemToGive->OwningInventory : nullptr;
+
+		// The client names the item and the inventories, both have to be ones this character can reach right now
+		if (!ItemInventorySource || !CanAccessInventory(ItemInventorySource) || (TargetInventory && !CanAccessInventory(TargetInventory)))
+		{
+			return;
+		}
+
+		if (TargetInventory)
 		{
-			if (TargetInventory)
+			if (ItemInventorySource == TargetInventory)
+			{
+				return;
+			}
+
+			if (ItemInventorySource->HasItem(ItemToGive->GetClass(), ItemToGive->GetQuantity()))
 			{
-				if (ItemInventorySource == TargetInventory)
+				const FSIItemAddResult AddResult = TargetInventory->TryAddItem(ItemToGive, TargetTile);
+
+				// What didn't fit is left on the item, it only goes once all of it was added
+				if (AddResult.Result == ESIItemAddResult::IAR_AllItemsAdded)
 				{
-					return;
+					ItemInventorySource->ConsumeItem(ItemToGive);
 				}
-			
-				if (ItemInventorySource->HasItem(ItemToGive->GetClass(), ItemToGive->GetQuantity()))
+				else if (AddResult.AmountGiven <= 0)
 				{
-					const FSIItemAddResult AddResult = TargetInventory->TryAddItem(ItemToGive, TargetTile);
-
-					if (AddResult.AmountGiven > 0)
-					{
-						ItemInventorySource->ConsumeItem(ItemToGive, AddResult.AmountGiven);
-					}
-					else
+					if (ASIPlayerController* PC = Cast<ASIPlayerController>(GetController()))
 					{
-						if (ASIPlayerController* PC = Cast<ASIPlayerController>(GetController()))
-						{
-							// PC->ClientShowNotification(AddResult.ErrorText);
-						}
+						// PC->ClientShowNotification(AddResult.ErrorText);
 					}
 				}
 			}
-			else
+		}
+		else
+		{
+			const FSIItemAddResult AddResult = TryAddItemToInventories(ItemToGive);
+
+			if (AddResult.AmountGiven >= AddResult.AmountToGive)
 			{
-				FSIItemAddResult AddResult;
-		
-				// for (auto& Inventory : GetInventoryList()) // TODO: Update for taking all inventories
-				if (USIInventoryComponent* Inventory = InventoryComponent)
-				{
-					if (Inventory)
-					{
-						AddResult = Inventory->TryAddItem(ItemToGive, FInventoryTile());
-
-						if (AddResult.AmountGiven >= ItemToGive->GetQuantity())
-						{
-							ItemInventorySource->ConsumeItem(ItemToGive, AddResult.AmountGiven);
-
-							return;
-						}
-				
-						if (AddResult.AmountGiven < ItemToGive->GetQuantity())
-						{
-							ItemToGive->SetQuantity(ItemToGive->GetQuantity() - AddResult.AmountGiven);
-						}
-					}
-				}
+				ItemInventorySource->ConsumeItem(ItemToGive);
+			}
 
-				if (!AddResult.ErrorText.IsEmpty())
+			if (!AddResult.ErrorText.IsEmpty())
+			{
+				if (ASIPlayerController* PC = Cast<ASIPlayerController>(GetController()))
 				{
-					if (ASIPlayerController* PC = Cast<ASIPlayerController>(GetController()))
-					{
-						// PC->ClientShowNotification(AddResult.ErrorText);
-					}
+					// PC->ClientShowNotification(AddResult.ErrorText);
 				}
 			}
 		}
@@ -220,7 +241,10 @@ void ASICharacter::MoveItem(USIItem* ItemToMove, USIInventoryComponent* TargetIn
 		{
 			if (ItemToMove->OwningInventory == TargetInventory)
 			{
-				TargetInventory->TryMoveItem(ItemToMove, TargetTile);
+				if (CanAccessInventory(TargetInventory))
+				{
+					TargetInventory->TryMoveItem(ItemToMove, TargetTile);
+				}
 			}
 			else
 			{
@@ -239,6 +263,151 @@ void ASICharacter::ServerMoveItem_Implementation(USIItem* ItemToMove, USIInvento
 	MoveItem(ItemToMove, TargetInventory, TargetTile);
 }
 
+void ASICharacter::AddInventory(USIInventoryComponent* Inventory)
+{
+	if (Inventory && !InventoryList.Contains(Inventory))
+	{
+		// Insert after everything of the same priority, so ties keep the order they were added in
+		const int32 Index = Algo::UpperBound(InventoryList, Inventory, [](const USIInventoryComponent* A, const USIInventoryComponent* B)
+		{
+			return A->RoutingPriority < B->RoutingPriority;
+		});
+
+		InventoryList.Insert(Inventory, Index);
+
+		Inventory->OnInventoryItemAdded.AddUObject(this, &ASICharacter::HandleInventoryItemAdded);
+		Inventory->OnInventoryItemRemoved.AddUObject(this, &ASICharacter::HandleInventoryItemRemoved);
+
+		// Containers that were already in there
+		for (const TPair<USIItem*, FInventoryTile>& ItemTile : Inventory->GetItemsMap())
+		{
+			HandleInventoryItemAdded(ItemTile.Key, ItemTile.Value);
+		}
+	}
+}
+
+void ASICharacter::RemoveInventory(USIInventoryComponent* Inventory)
+{
+	if (Inventory && InventoryList.Remove(Inventory) > 0)
+	{
+		Inventory->OnInventoryItemAdded.RemoveAll(this);
+		Inventory->OnInventoryItemRemoved.RemoveAll(this);
+	}
+}
+
+void ASICharacter::HandleInventoryItemAdded(USIItem* Item, const FInventoryTile& Tile)
+{
+	USIContainerItem* Container = Cast<USIContainerItem>(Item);
+
+	// Grids are only created on the server, and loot is only routed there
+	if (Container && HasAuthority())
+	{
+		AddInventory(Container->GetOrCreateInnerInventory());
+	}
+}
+
+void ASICharacter::HandleInventoryItemRemoved(USIItem* Item, const FInventoryTile& Tile)
+{
+	if (USIContainerItem* Container = Cast<USIContainerItem>(Item))
+	{
+		// A container moved within our inventories still has the grid, it is added back when the copy is. Dropped ones
+		// had theirs recreated on the pickup, which destroyed the one in the list
+		RemoveInventory(Container->GetInnerInventory());
+
+		InventoryList.RemoveAll([](const USIInventoryComponent* Inventory)
+		{
+			return !IsValid(Inventory);
+		});
+	}
+}
+
+bool ASICharacter::OwnsInventory(const USIInventoryComponent* Inventory) const
+{
+	for (; Inventory; Inventory = Inventory->OwnerContainer ? Inventory->OwnerContainer->OwningInventory : nullptr)
+	{
+		if (InventoryList.Contains(Inventory))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+FSIItemAddResult ASICharacter::TryAddItemToInventories(USIItem* Item)
+{
+	if (!Item || !HasAuthority())
+	{
+		return FSIItemAddResult::AddedNone(Item ? Item->GetQuantity() : 0, FText::FromString(""));
+	}
+
+	const int32 Quantity = Item->GetQuantity();
+	int32 Remaining = Quantity;
+
+	// Top up the stacks that have room first, across every inventory, the summaries tell us where they are
+	if (Item->IsStackable())
+	{
+		for (USIInventoryComponent* Inventory : InventoryList)
+		{
+			if (Remaining <= 0)
+			{
+				break;
+			}
+
+			if (Inventory && Inventory->GetRoutingSummary().GetStackRoom(Item->GetClass()) > 0 && Inventory->CanHoldItem(Item))
+			{
+				Remaining -= Inventory->TopUpStacks(Item, Remaining);
+			}
+		}
+
+		if (Remaining <= 0)
+		{
+			return FSIItemAddResult::AddedAll(Item, Quantity);
+		}
+
+		Item->SetQuantity(Remaining);
+	}
+
+	// Then the first inventory that has a gap for the item in either orientation and can carry at least one of it
+	const FIntPoint Dimensions = Item->GetBaseDimensions();
+
+	for (USIInventoryComponent* Inventory : InventoryList)
+	{
+		if (!Inventory || !Inventory->CanHoldItem(Item))
+		{
+			continue;
+		}
+
+		const FSIInventoryRoutingSummary& Summary = Inventory->GetRoutingSummary();
+
+		if (!Summary.CanFit(Dimensions) && !Summary.CanFit(FIntPoint(Dimensions.Y, Dimensions.X)))
+		{
+			continue;
+		}
+
+		if (SIInventory::GetMaxQuantityForWeight(Inventory->GetRemainingWeight(), Item->GetUnitWeight(), 1) <= 0)
+		{
+			continue;
+		}
+
+		const FSIItemAddResult AddResult = Inventory->TryAddItem(Item, FInventoryTile());
+
+		if (AddResult.Result == ESIItemAddResult::IAR_AllItemsAdded)
+		{
+			return FSIItemAddResult::AddedAll(Item, Quantity);
+		}
+
+		// The item is left with what didn't fit, the next inventory gets a go at it
+		Remaining = Item->GetQuantity();
+	}
+
+	const FText ErrorText = FText::Format(FText::FromString("Couldn't add {ItemName} to Inventory. Inventory is full."), Item->GetDisplayName());
+
+	return Remaining < Quantity
+		? FSIItemAddResult::AddedSome(Item, Quantity, Quantity - Remaining, ErrorText)
+		: FSIItemAddResult::AddedNone(Quantity, ErrorText);
+}
+
 void ASICharacter::DropItem(USIItem* Item, const int32 Quantity)
 {
 	if (!HasAuthority())
@@ -247,12 +416,11 @@ void ASICharacter::DropItem(USIItem* Item, const int32 Quantity)
 	}
 	else
 	{
-		if (Quantity > 0 && Item && (Item->OwningInventory && Item->OwningInventory->FindItem(Item))) // TODO: Update for taking all inventories
+		if (Quantity > 0 && Item && OwnsInventory(Item->OwningInventory) && Item->OwningInventory->FindItem(Item))
 		{
+			USIInventoryComponent* SourceInventory = Item->OwningInventory;
 			const int32 ItemQuantity = Item->GetQuantity();
-			int32 DroppedQuantity;
-			
-			DroppedQuantity = Item->OwningInventory->ConsumeItem(Item, Quantity);
+			const int32 DroppedQuantity = FMath::Min(Quantity, ItemQuantity);
 
 			FActorSpawnParameters SpawnParams;
 			SpawnParams.Owner = this;
@@ -277,6 +445,9 @@ void ASICharacter::DropItem(USIItem* Item, const int32 Quantity)
 					Pickup->InitializePickup(Item, DroppedQuantity);
 				}
 			}
+
+			// Taken out once the pickup has it, so a dropped container brings its grid along instead of having it released
+			SourceInventory->ConsumeItem(Item, DroppedQuantity);
 		}
 	}
 }
@@ -303,50 +474,361 @@ void ASICharacter::ServerDropItem_Implementation(USIItem* Item, const int32 Quan
 	DropItem(Item, Quantity);
 }
 
-void ASICharacter::PerformInteractionCheck()
+void ASICharacter::SplitStack(USIItem* Item, const int32 SplitQuantity, const FInventoryTile TargetTile)
 {
-	if (GetController() == nullptr)
+	if (HasAuthority())
 	{
-		return;
+		if (Item && OwnsInventory(Item->OwningInventory))
+		{
+			Item->OwningInventory->SplitStack(Item, SplitQuantity, TargetTile);
+		}
+	}
+	else
+	{
+		ServerSplitStack(Item, SplitQuantity, TargetTile);
 	}
+}
 
-	InteractionData.LastInteractionCheckTime = GetWorld()->GetTimeSeconds();
+void ASICharacter::ServerSplitStack_Implementation(USIItem* Item, const int32 SplitQuantity, const FInventoryTile TargetTile)
+{
+	SplitStack(Item, SplitQuantity, TargetTile);
+}
+
+void ASICharacter::MergeStacks(USIItem* SourceItem, USIItem* TargetItem)
+{
+	if (HasAuthority())
+	{
+		if (SourceItem && TargetItem && OwnsInventory(SourceItem->OwningInventory))
+		{
+			if (SourceItem->OwningInventory == TargetItem->OwningInventory)
+			{
+				SourceItem->OwningInventory->MergeStacks(SourceItem, TargetItem);
+			}
+			else if (CanAccessInventory(TargetItem->OwningInventory))
+			{
+				// Stacks in different inventories go through the regular move, which stacks onto the item at the tile
+				FInventoryTile TargetTile;
+
+				if (TargetItem->OwningInventory->GetItemTile(TargetItem, TargetTile))
+				{
+					MoveItem(SourceItem, TargetItem->OwningInventory, TargetTile);
+				}
+			}
+		}
+	}
+	else
+	{
+		ServerMergeStacks(SourceItem, TargetItem);
+	}
+}
+
+void ASICharacter::ServerMergeStacks_Implementation(USIItem* SourceItem, USIItem* TargetItem)
+{
+	MergeStacks(SourceItem, TargetItem);
+}
+
+void ASICharacter::ConsolidateStacks(USIInventoryComponent* Inventory)
+{
+	if (HasAuthority())
+	{
+		if (OwnsInventory(Inventory))
+		{
+			Inventory->ConsolidateStacks();
+		}
+	}
+	else
+	{
+		ServerConsolidateStacks(Inventory);
+	}
+}
+
+void ASICharacter::ServerConsolidateStacks_Implementation(USIInventoryComponent* Inventory)
+{
+	ConsolidateStacks(Inventory);
+}
+
+void ASICharacter::OpenContainer(USIContainerItem* Container)
+{
+	if (HasAuthority())
+	{
+		if (Container && CanReachContainer(Container))
+		{
+			Container->OpenFor(Cast<APlayerController>(GetController()));
+		}
+	}
+	else
+	{
+		ServerOpenContainer(Container);
+	}
+}
+
+void ASICharacter::ServerOpenContainer_Implementation(USIContainerItem* Container)
+{
+	OpenContainer(Container);
+}
+
+void ASICharacter::CloseContainer(USIContainerItem* Container)
+{
+	if (HasAuthority())
+	{
+		if (Container)
+		{
+			Container->CloseFor(Cast<APlayerController>(GetController()));
+		}
+	}
+	else
+	{
+		ServerCloseContainer(Container);
+	}
+}
+
+void ASICharacter::ServerCloseContainer_Implementation(USIContainerItem* Container)
+{
+	CloseContainer(Container);
+}
+
+bool ASICharacter::CanAccessInventory(const USIInventoryComponent* Inventory) const
+{
+	if (OwnsInventory(Inventory))
+	{
+		return true;
+	}
+
+	return Inventory && Inventory->OwnerContainer && CanReachContainer(Inventory->OwnerContainer);
+}
+
+bool ASICharacter::CanReachContainer(const USIContainerItem* Container) const
+{
+	const AActor* ContainerActor = Container->GetTypedOuter<AActor>();
+
+	if (!ContainerActor)
+	{
+		return false;
+	}
+
+	if (ContainerActor == this)
+	{
+		return true;
+	}
+
+	// Someone else's backpack, being in reach isn't enough
+	if (ContainerActor->IsA<APawn>() && !bCanOpenOtherPawnsContainers)
+	{
+		return false;
+	}
+
+	return FVector::DistSquared(ContainerActor->GetActorLocation(), GetActorLocation()) <= FMath::Square(InteractionCheckDistance + InteractionValidationTolerance);
+}
+
+bool ASICharacter::GetInteractionTraceParams(FVector& OutTraceStart, FVector& OutTraceEnd, FCollisionQueryParams& OutQueryParams) const
+{
+	if (GetController() == nullptr)
+	{
+		return false;
+	}
 
 	FVector EyesLoc;
 	FRotator EyesRot;
 
 	GetController()->GetPlayerViewPoint(EyesLoc, EyesRot);
 
-	FVector TraceStart = EyesLoc;
-	FVector TraceEnd = (EyesRot.Vector() * InteractionCheckDistance) + TraceStart;
-	FHitResult TraceHit;
+	OutTraceStart = EyesLoc;
+	OutTraceEnd = (EyesRot.Vector() * InteractionCheckDistance) + OutTraceStart;
+
+	OutQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(SIInteractionCheck), false, this);
+
+	return true;
+}
 
+void ASICharacter::PerformInteractionCheck()
+{
+	FVector TraceStart;
+	FVector TraceEnd;
 	FCollisionQueryParams QueryParams;
 
-	TArray<AActor*> IgnoredActors;
-	IgnoredActors.Add(this);
+	if (!GetInteractionTraceParams(TraceStart, TraceEnd, QueryParams))
+	{
+		return;
+	}
+
+	InteractionData.LastInteractionCheckTime = GetWorld()->GetTimeSeconds();
 
-	QueryParams.AddIgnoredActors(IgnoredActors);
+	FHitResult TraceHit;
 
 	if (bCanInteract && GetWorld()->LineTraceSingleByChannel(TraceHit, TraceStart, TraceEnd, COLLISION_INTERACTION, QueryParams))
 	{
-		if (TraceHit.GetActor())
+		HandleInteractionTraceResult(TraceStart, &TraceHit);
+	}
+	else
+	{
+		HandleInteractionTraceResult(TraceStart, nullptr);
+	}
+}
+
+void ASICharacter::RequestInteractionCheck()
+{
+	FVector TraceStart;
+	FVector TraceEnd;
+	FCollisionQueryParams QueryParams;
+
+	if (!GetInteractionTraceParams(TraceStart, TraceEnd, QueryParams))
+	{
+		return;
+	}
+
+	InteractionData.LastInteractionCheckTime = GetWorld()->GetTimeSeconds();
+
+	if (!bCanInteract)
+	{
+		HandleInteractionTraceResult(TraceStart, nullptr);
+		return;
+	}
+
+	if (InteractionSelectionMode == ESIInteractionSelectionMode::ISM_ScoredCandidates)
+	{
+		USIInteractionComponent* Candidate = SelectInteractionCandidate(TraceStart, (TraceEnd - TraceStart).GetSafeNormal());
+
+		if (!Candidate)
 		{
-			if (USIInteractionComponent* InteractionComponent = Cast<USIInteractionComponent>(TraceHit.GetActor()->GetComponentByClass(USIInteractionComponent::StaticClass())))
-			{
-				float Distance = (TraceStart - TraceHit.ImpactPoint).Size();
+			HandleInteractionTraceResult(TraceStart, nullptr);
+			return;
+		}
 
-				if (InteractionComponent != GetInteractable() && Distance <= InteractionComponent->InteractionDistance)
-				{
-					FoundNewInteractable(TraceHit.GetActor(), InteractionComponent);
-				}
-				else if (Distance > InteractionComponent->InteractionDistance && GetInteractable())
-				{
-					CouldntFindInteractable();
-				}
+		// Confirm the best candidate with a single trace towards it, going a bit past its origin so we hit its collision
+		const FVector ToCandidate = Candidate->GetOwner()->GetActorLocation() - TraceStart;
+		TraceEnd = TraceStart + ToCandidate + ToCandidate.GetSafeNormal() * 50.f;
+	}
 
-				return;
+	InteractionTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, COLLISION_INTERACTION, QueryParams);
+}
+
+USIInteractionComponent* ASICharacter::SelectInteractionCandidate(const FVector& ViewLocation, const FVector& ViewDirection) const
+{
+	USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>();
+
+	if (!InteractionSubsystem)
+	{
+		return nullptr;
+	}
+
+	TArray<USIInteractionComponent*, TInlineAllocator<32>> Candidates;
+	InteractionSubsystem->GatherInteractables(ViewLocation, InteractionCheckDistance, Candidates);
+
+	const float MinDot = FMath::Cos(FMath::DegreesToRadians(InteractionCandidateHalfAngle));
+
+	// Candidates outside the view cone or out of reach are dropped before anything is ranked, so a close item behind the
+	// player can't take the place of the one aimed at. The best ones by score are kept in a min-heap bounded by the budget
+	struct FScoredCandidate
+	{
+		float Score;
+		USIInteractionComponent* Candidate;
+
+		bool operator<(const FScoredCandidate& Other) const { return Score < Other.Score; }
+	};
+
+	TArray<FScoredCandidate, TInlineAllocator<32>> BestCandidates;
+	const int32 Budget = FMath::Max(InteractionCandidateBudget, 1);
+
+	for (USIInteractionComponent* Candidate : Candidates)
+	{
+		if (!Candidate->IsActive() || Candidate->GetOwner() == this)
+		{
+			continue;
+		}
+
+		const FVector ToCandidate = Candidate->GetOwner()->GetActorLocation() - ViewLocation;
+		const float Distance = ToCandidate.Size();
+		const float MaxDistance = FMath::Min(InteractionCheckDistance, Candidate->InteractionDistance);
+
+		if (Distance > MaxDistance || Distance <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		const float Dot = FVector::DotProduct(ToCandidate / Distance, ViewDirection);
+
+		if (Dot < MinDot)
+		{
+			continue;
+		}
+
+		const float AngleScore = (Dot - MinDot) / FMath::Max(1.f - MinDot, KINDA_SMALL_NUMBER);
+		const float DistanceScore = 1.f - (Distance / MaxDistance);
+		const float Score = (InteractionAngleWeight * AngleScore) + (InteractionDistanceWeight * DistanceScore);
+
+		if (BestCandidates.Num() < Budget)
+		{
+			BestCandidates.HeapPush({ Score, Candidate });
+		}
+		else if (Score > BestCandidates.HeapTop().Score)
+		{
+			BestCandidates.HeapPopDiscard(false);
+			BestCandidates.HeapPush({ Score, Candidate });
+		}
+	}
+
+	USIInteractionComponent* BestCandidate = nullptr;
+	float BestScore = -MAX_FLT;
+
+	for (const FScoredCandidate& Scored : BestCandidates)
+	{
+		if (Scored.Score > BestScore)
+		{
+			BestScore = Scored.Score;
+			BestCandidate = Scored.Candidate;
+		}
+	}
+
+	return BestCandidate;
+}
+
+void ASICharacter::ConsumeInteractionCheck()
+{
+	if (!InteractionTraceHandle.IsValid())
+	{
+		return;
+	}
+
+	FTraceDatum TraceDatum;
+
+	if (GetWorld()->QueryTraceData(InteractionTraceHandle, TraceDatum))
+	{
+		InteractionTraceHandle = FTraceHandle();
+
+		const FHitResult* TraceHit = TraceDatum.OutHits.FindByPredicate([](const FHitResult& Hit)
+		{
+			return Hit.bBlockingHit;
+		});
+
+		// Interaction may have been disabled while the trace was in flight
+		HandleInteractionTraceResult(TraceDatum.Start, bCanInteract ? TraceHit : nullptr);
+	}
+	else if (!GetWorld()->IsTraceHandleValid(InteractionTraceHandle, false))
+	{
+		InteractionTraceHandle = FTraceHandle();
+	}
+}
+
+void ASICharacter::HandleInteractionTraceResult(const FVector& TraceStart, const FHitResult* TraceHit)
+{
+	USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>();
+
+	if (TraceHit && TraceHit->GetActor() && InteractionSubsystem)
+	{
+		if (USIInteractionComponent* InteractionComponent = InteractionSubsystem->FindInteractable(TraceHit->GetActor()))
+		{
+			float Distance = (TraceStart - TraceHit->ImpactPoint).Size();
+
+			if (InteractionComponent != GetInteractable() && Distance <= InteractionComponent->InteractionDistance)
+			{
+				FoundNewInteractable(TraceHit->GetActor(), InteractionComponent);
+			}
+			else if (Distance > InteractionComponent->InteractionDistance && GetInteractable())
+			{
+				CouldntFindInteractable();
 			}
+
+			return;
 		}
 	}
 
@@ -355,9 +837,9 @@ void ASICharacter::PerformInteractionCheck()
 
 void ASICharacter::CouldntFindInteractable()
 {
-	if (GetWorldTimerManager().IsTimerActive(TimerHandle_Interact))
+	if (USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>())
 	{
-		GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
+		InteractionSubsystem->EndInteraction(this);
 	}
 
 	if (USIInteractionComponent* Interactable = GetInteractable())
@@ -396,12 +878,7 @@ void ASICharacter::BeginInteract()
 {
 	if (!HasAuthority())
 	{
-		ServerBeginInteract();
-	}
-
-	if (HasAuthority()/* && IsAlive()*/) // TODO: Handle if implement Health System
-	{
-		PerformInteractionCheck();
+		ServerBeginInteract(GetInteractable());
 	}
 
 	InteractionData.bInteractHeld = true;
@@ -414,9 +891,9 @@ void ASICharacter::BeginInteract()
 		{
 			Interact();
 		}
-		else
+		else if (USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>())
 		{
-			GetWorldTimerManager().SetTimer(TimerHandle_Interact, this, &ASICharacter::Interact, Interactable->InteractionTime, false);
+			InteractionSubsystem->BeginInteraction(this, Interactable);
 		}
 	}
 }
@@ -430,7 +907,10 @@ void ASICharacter::EndInteract()
 
 	InteractionData.bInteractHeld = false;
 
-	GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
+	if (USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>())
+	{
+		InteractionSubsystem->EndInteraction(this);
+	}
 
 	if (USIInteractionComponent* Interactable = GetInteractable())
 	{
@@ -440,7 +920,10 @@ void ASICharacter::EndInteract()
 
 void ASICharacter::Interact()
 {
-	GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
+	if (USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>())
+	{
+		InteractionSubsystem->EndInteraction(this);
+	}
 
 	if (USIInteractionComponent* Interactable = GetInteractable())
 	{
@@ -448,6 +931,20 @@ void ASICharacter::Interact()
 	}
 }
 
+bool ASICharacter::IsInteracting() const
+{
+	const USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>();
+
+	return InteractionSubsystem && InteractionSubsystem->IsInteracting(this);
+}
+
+float ASICharacter::GetRemainingInteractTime() const
+{
+	const USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>();
+
+	return InteractionSubsystem ? InteractionSubsystem->GetRemainingInteractTime(this) : 0.f;
+}
+
 void ASICharacter::SetCanInteract(bool Value)
 {
 	if (HasAuthority())
@@ -480,11 +977,74 @@ void ASICharacter::ServerEndInteract_Implementation()
 	EndInteract();
 }
 
-void ASICharacter::ServerBeginInteract_Implementation()
+void ASICharacter::ServerBeginInteract_Implementation(USIInteractionComponent* Target)
 {
+	// TODO: Handle if implement Health System
+	if (ValidateInteractionTarget(Target))
+	{
+		// The server only needs the target. Focusing, with its outline and prompt, is for the owning client to show
+		if (Target != GetInteractable())
+		{
+			EndInteract();
+
+			InteractionData.ViewedInteractionComponent = Target;
+			CurrentInteractingActor = Target->GetOwner();
+		}
+	}
+	else
+	{
+		CouldntFindInteractable();
+	}
+
 	BeginInteract();
 }
 
+bool ASICharacter::ValidateInteractionTarget(USIInteractionComponent* Target) const
+{
+	if (!bCanInteract || !Target || !Target->IsActive() || !Target->GetOwner() || !GetController())
+	{
+		return false;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+
+	GetController()->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const FVector TargetLocation = Target->GetOwner()->GetActorLocation();
+	const FVector ToTarget = TargetLocation - ViewLocation;
+	const float Distance = ToTarget.Size();
+
+	if (Distance > Target->InteractionDistance + InteractionValidationTolerance)
+	{
+		return false;
+	}
+
+	// Up close the direction to the actor's origin is meaningless, the distance check is enough
+	if (Distance > InteractionValidationTolerance)
+	{
+		const float MinDot = FMath::Cos(FMath::DegreesToRadians(InteractionValidationHalfAngle));
+
+		if (FVector::DotProduct(ToTarget / Distance, ViewRotation.Vector()) < MinDot)
+		{
+			return false;
+		}
+	}
+
+	if (bValidateInteractionWithTrace)
+	{
+		FHitResult TraceHit;
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SIInteractionValidation), false, this);
+
+		if (GetWorld()->LineTraceSingleByChannel(TraceHit, ViewLocation, TargetLocation, COLLISION_INTERACTION, QueryParams))
+		{
+			return TraceHit.GetActor() == Target->GetOwner();
+		}
+	}
+
+	return true;
+}
+
 void ASICharacter::TouchStarted(ETouchIndex::Type FingerIndex, FVector Location)
 {
 	Jump();
@@ -3,7 +3,13 @@
 
 #include "Widgets/SIHUD.h"
 
+#include "Components/SIInteractionComponent.h"
+#include "Components/SIInventoryComponent.h"
+#include "Items/SIItem.h"
+#include "Player/SICharacter.h"
 #include "Widgets/SIGameplayWidget.h"
+#include "Widgets/SIInteractionWidget.h"
+#include "Widgets/SIItemTooltipWidget.h"
 #include "Widgets/SIInventoryWidget.h"
 
 ASIHUD::ASIHUD()
@@ -15,6 +21,13 @@ void ASIHUD::BeginPlay()
 	Super::BeginPlay();
 }
 
+void ASIHUD::DrawHUD()
+{
+	Super::DrawHUD();
+
+	UpdateInteractionPromptPosition();
+}
+
 void ASIHUD::CreateGameplayWidget()
 {
 	if (!GameplayWidget && GameplayWidgetClass && PlayerOwner && !PlayerOwner.IsNull())
@@ -60,6 +73,17 @@ void ASIHUD::OpenInventoryWidget()
 
 	if (InventoryWidget && !InventoryWidget->IsInViewport())
 	{
+		if (ASICharacter* Character = Cast<ASICharacter>(PlayerOwner->GetPawn()))
+		{
+			if (USIInventoryComponent* Inventory = Character->GetInventoryComponent())
+			{
+				Inventory->PreloadThumbnails();
+				PrewarmItemTooltips(Inventory);
+
+				InventoryWidget->SetInventory(Inventory);
+			}
+		}
+
 		InventoryWidget->AddToViewport();
 
 		FInputModeGameAndUI UIInput;
@@ -70,6 +94,57 @@ void ASIHUD::OpenInventoryWidget()
 	}
 }
 
+USIItemTooltipWidget* ASIHUD::GetItemTooltip(USIItem* Item)
+{
+	if (!Item)
+	{
+		return nullptr;
+	}
+
+	USIItemTooltipWidget* Tooltip = FindOrCreateItemTooltip(Item->GetItemTooltipClass());
+
+	if (Tooltip && Tooltip->Item != Item)
+	{
+		Tooltip->SetItem(Item);
+	}
+
+	return Tooltip;
+}
+
+void ASIHUD::PrewarmItemTooltips(USIInventoryComponent* Inventory)
+{
+	if (!Inventory)
+	{
+		return;
+	}
+
+	for (const TPair<USIItem*, FInventoryTile>& ItemTile : Inventory->GetItemsMap())
+	{
+		if (ItemTile.Key)
+		{
+			FindOrCreateItemTooltip(ItemTile.Key->GetItemTooltipClass());
+		}
+	}
+}
+
+USIItemTooltipWidget* ASIHUD::FindOrCreateItemTooltip(TSubclassOf<USIItemTooltipWidget> TooltipClass)
+{
+	if (!TooltipClass || !PlayerOwner)
+	{
+		return nullptr;
+	}
+
+	if (USIItemTooltipWidget** Tooltip = ItemTooltips.Find(TooltipClass))
+	{
+		return *Tooltip;
+	}
+
+	USIItemTooltipWidget* Tooltip = CreateWidget<USIItemTooltipWidget>(PlayerOwner.Get(), TooltipClass);
+	ItemTooltips.Add(TooltipClass, Tooltip);
+
+	return Tooltip;
+}
+
 void ASIHUD::CloseInventoryWidget()
 {
 	if (InventoryWidget && InventoryWidget->IsInViewport())
@@ -80,3 +155,76 @@ void ASIHUD::CloseInventoryWidget()
 		PlayerOwner->SetInputMode(FInputModeGameOnly());
 	}
 }
+
+void ASIHUD::ShowInteractionPrompt(USIInteractionComponent* Interactable)
+{
+	if (!Interactable)
+	{
+		return;
+	}
+
+	if (!InteractionWidget && InteractionWidgetClass && PlayerOwner)
+	{
+		InteractionWidget = CreateWidget<USIInteractionWidget>(PlayerOwner.Get(), InteractionWidgetClass);
+
+		if (InteractionWidget)
+		{
+			InteractionWidget->SetAlignmentInViewport(FVector2D(0.5f, 1.f));
+			InteractionWidget->AddToViewport();
+		}
+	}
+
+	if (InteractionWidget)
+	{
+		InteractionWidget->UpdateInteractionWidget(Interactable);
+		InteractionWidget->UpdateInteractProgress(Interactable->GetInteractPercentage());
+
+		UpdateInteractionPromptPosition();
+	}
+}
+
+void ASIHUD::HideInteractionPrompt(USIInteractionComponent* Interactable)
+{
+	if (InteractionWidget && InteractionWidget->OwningInteractionComponent == Interactable)
+	{
+		InteractionWidget->OwningInteractionComponent = nullptr;
+		InteractionWidget->SetVisibility(ESlateVisibility::Collapsed);
+	}
+}
+
+void ASIHUD::RefreshInteractionPrompt(USIInteractionComponent* Interactable)
+{
+	if (InteractionWidget && Interactable && InteractionWidget->OwningInteractionComponent == Interactable)
+	{
+		InteractionWidget->UpdateInteractionWidget(Interactable);
+	}
+}
+
+void ASIHUD::UpdateInteractionPromptProgress(USIInteractionComponent* Interactable, const float Progress)
+{
+	if (InteractionWidget && Interactable && InteractionWidget->OwningInteractionComponent == Interactable)
+	{
+		InteractionWidget->UpdateInteractProgress(Progress);
+	}
+}
+
+void ASIHUD::UpdateInteractionPromptPosition()
+{
+	if (!InteractionWidget || !PlayerOwner)
+	{
+		return;
+	}
+
+	USIInteractionComponent* Interactable = InteractionWidget->OwningInteractionComponent;
+	FVector2D ScreenPosition;
+
+	if (Interactable && PlayerOwner->ProjectWorldLocationToScreen(Interactable->GetPromptLocation(), ScreenPosition, true))
+	{
+		InteractionWidget->SetPositionInViewport(ScreenPosition);
+		InteractionWidget->SetVisibility(ESlateVisibility::HitTestInvisible);
+	}
+	else
+	{
+		InteractionWidget->SetVisibility(ESlateVisibility::Collapsed);
+	}
+}
@@ -7,4 +7,9 @@ void USIInteractionWidget::UpdateInteractionWidget(USIInteractionComponent* Inte
 {
 	OwningInteractionComponent = InteractionComponent;
 	OnUpdateInteractionWidget();
+}
+
+void USIInteractionWidget::UpdateInteractProgress(const float Progress)
+{
+	OnUpdateInteractProgress(Progress);
 }
\ No newline at end of file
@@ -0,0 +1,286 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/SIInventoryGridWidget.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "Framework/SIThumbnailAtlasSubsystem.h"
+#include "Items/SIItem.h"
+#include "Styling/CoreStyle.h"
+#include "Widgets/SSIInventoryGrid.h"
+
+#define LOCTEXT_NAMESPACE "SIInventoryGridWidget"
+
+USIInventoryGridWidget::USIInventoryGridWidget()
+{
+	Style.StackCountFont = FCoreStyle::GetDefaultFontStyle("Bold", 10);
+	Style.Background.DrawAs = ESlateBrushDrawType::NoDrawType;
+}
+
+void USIInventoryGridWidget::SetInventory(USIInventoryComponent* NewInventory)
+{
+	if (NewInventory == Inventory)
+	{
+		return;
+	}
+
+	UnbindInventory();
+
+	Inventory = NewInventory;
+	PlacementHighlightItem.Reset();
+	PlacementHighlightVersion = INDEX_NONE;
+
+	BindInventory();
+
+	if (MyGrid.IsValid())
+	{
+		MyGrid->SetInventory(Inventory);
+	}
+}
+
+void USIInventoryGridWidget::SetStyle(const FSIInventoryGridStyle& NewStyle)
+{
+	Style = NewStyle;
+
+	if (MyGrid.IsValid())
+	{
+		MyGrid->SetStyle(Style);
+	}
+}
+
+bool USIInventoryGridWidget::GetTileAtScreenPosition(FVector2D ScreenPosition, FInventoryTile& OutTile) const
+{
+	return MyGrid.IsValid() && MyGrid->GetTileAtPosition(MyGrid->GetTickSpaceGeometry(), ScreenPosition, OutTile);
+}
+
+USIItem* USIInventoryGridWidget::GetItemAtScreenPosition(FVector2D ScreenPosition) const
+{
+	FInventoryTile Tile;
+
+	return Inventory && GetTileAtScreenPosition(ScreenPosition, Tile) ? Inventory->GetItemAtTile(Tile) : nullptr;
+}
+
+void USIInventoryGridWidget::SetDragPreview(USIItem* Item, FInventoryTile Tile, bool bValid)
+{
+	if (MyGrid.IsValid())
+	{
+		MyGrid->SetDragPreview(Item, Tile, bValid);
+	}
+}
+
+void USIInventoryGridWidget::ClearDragPreview()
+{
+	if (MyGrid.IsValid())
+	{
+		MyGrid->ClearDragPreview();
+	}
+}
+
+void USIInventoryGridWidget::SetPlacementHighlight(USIItem* Item, bool bCurrentDimensions)
+{
+	if (!MyGrid.IsValid() || !Inventory || !Item)
+	{
+		return;
+	}
+
+	const FIntPoint Dimensions = Item->GetDimensions(bCurrentDimensions);
+
+	if (PlacementHighlightItem.Get() == Item && PlacementHighlightDimensions == Dimensions && PlacementHighlightVersion == Inventory->GetInventoryVersion())
+	{
+		return;
+	}
+
+	PlacementHighlightItem = Item;
+	PlacementHighlightDimensions = Dimensions;
+	PlacementHighlightVersion = Inventory->GetInventoryVersion();
+
+	MyGrid->SetPlacementHighlight(Inventory->GetPlacementMask(Item, bCurrentDimensions));
+}
+
+void USIInventoryGridWidget::ClearPlacementHighlight()
+{
+	PlacementHighlightItem.Reset();
+	PlacementHighlightVersion = INDEX_NONE;
+
+	if (MyGrid.IsValid())
+	{
+		MyGrid->ClearPlacementHighlight();
+	}
+}
+
+void USIInventoryGridWidget::SynchronizeProperties()
+{
+	Super::SynchronizeProperties();
+
+	if (MyGrid.IsValid())
+	{
+		MyGrid->SetStyle(Style);
+	}
+}
+
+void USIInventoryGridWidget::ReleaseSlateResources(bool bReleaseChildren)
+{
+	Super::ReleaseSlateResources(bReleaseChildren);
+
+	MyGrid.Reset();
+}
+
+#if WITH_EDITOR
+const FText USIInventoryGridWidget::GetPaletteCategory()
+{
+	return LOCTEXT("Inventory", "Inventory");
+}
+#endif
+
+TSharedRef<SWidget> USIInventoryGridWidget::RebuildWidget()
+{
+	MyGrid = SNew(SSIInventoryGrid)
+		.Style(Style)
+		.OnTileClicked(BIND_UOBJECT_DELEGATE(FOnSIInventoryGridClicked, HandleTileClicked))
+		.OnHoveredTileChanged(BIND_UOBJECT_DELEGATE(FOnSIInventoryGridHoverChanged, HandleHoveredTileChanged));
+
+	MyGrid->SetInventory(Inventory);
+
+	PlacementHighlightItem.Reset();
+	PlacementHighlightVersion = INDEX_NONE;
+
+	return MyGrid.ToSharedRef();
+}
+
+FReply USIInventoryGridWidget::HandleTileClicked(const FInventoryTile& Tile, const FPointerEvent& MouseEvent)
+{
+	if (!OnTileClicked.IsBound())
+	{
+		return FReply::Unhandled();
+	}
+
+	OnTileClicked.Broadcast(Tile, Inventory ? Inventory->GetItemAtTile(Tile) : nullptr, MouseEvent);
+
+	return FReply::Handled();
+}
+
+void USIInventoryGridWidget::HandleHoveredTileChanged(const FInventoryTile& Tile, bool bHovering)
+{
+	OnHoveredTileChanged.Broadcast(Tile, Inventory ? Inventory->GetItemAtTile(Tile) : nullptr, bHovering);
+}
+
+void USIInventoryGridWidget::HandleItemAdded(USIItem* Item, const FInventoryTile& Tile)
+{
+	HandleItemChanged(Item, Tile);
+
+	// Only new items can bring a thumbnail the atlas doesn't have yet
+	RequestThumbnail(Item);
+}
+
+void USIInventoryGridWidget::HandleItemChanged(USIItem* Item, const FInventoryTile& Tile)
+{
+	if (MyGrid.IsValid())
+	{
+		MyGrid->UpdateItem(Item, Tile);
+	}
+}
+
+void USIInventoryGridWidget::RequestThumbnail(USIItem* Item)
+{
+	if (!Item || !Inventory)
+	{
+		return;
+	}
+
+	const USIItemDefinition* ItemDefinition = Item->GetDefinition();
+
+	// Another item of the same kind is already streaming it in
+	if (ThumbnailRequests.Contains(ItemDefinition))
+	{
+		return;
+	}
+
+	if (!Item->GetThumbnailAsset().IsNull() && !Item->GetThumbnailAsset().Get())
+	{
+		TWeakObjectPtr<USIItem> WeakItem = Item;
+
+		TSharedPtr<FStreamableHandle> Handle = USIItem::RequestThumbnails({ Item }, FStreamableDelegate::CreateWeakLambda(this, [this, WeakItem, ItemDefinition]()
+		{
+			ThumbnailRequests.Remove(ItemDefinition);
+			AddThumbnailToAtlas(WeakItem.Get());
+		}));
+
+		if (Handle.IsValid())
+		{
+			ThumbnailRequests.Add(ItemDefinition, Handle);
+		}
+	}
+	else
+	{
+		AddThumbnailToAtlas(Item);
+	}
+}
+
+void USIInventoryGridWidget::AddThumbnailToAtlas(USIItem* Item)
+{
+	UGameInstance* GameInstance = Item && Inventory && Inventory->GetWorld() ? Inventory->GetWorld()->GetGameInstance() : nullptr;
+
+	if (USIThumbnailAtlasSubsystem* ThumbnailAtlas = GameInstance ? GameInstance->GetSubsystem<USIThumbnailAtlasSubsystem>() : nullptr)
+	{
+		ThumbnailAtlas->AddThumbnails({ Item });
+	}
+}
+
+void USIInventoryGridWidget::HandleItemRemoved(USIItem* Item, const FInventoryTile& Tile)
+{
+	if (MyGrid.IsValid())
+	{
+		MyGrid->RemoveItem(Item);
+	}
+}
+
+void USIInventoryGridWidget::HandleItemMoved(USIItem* Item, const FInventoryTile& FromTile, const FInventoryTile& ToTile)
+{
+	if (MyGrid.IsValid())
+	{
+		MyGrid->UpdateItem(Item, ToTile);
+	}
+}
+
+void USIInventoryGridWidget::BindInventory()
+{
+	if (!Inventory)
+	{
+		return;
+	}
+
+	ItemAddedHandle = Inventory->OnInventoryItemAdded.AddUObject(this, &USIInventoryGridWidget::HandleItemAdded);
+	ItemRemovedHandle = Inventory->OnInventoryItemRemoved.AddUObject(this, &USIInventoryGridWidget::HandleItemRemoved);
+	ItemMovedHandle = Inventory->OnInventoryItemMoved.AddUObject(this, &USIInventoryGridWidget::HandleItemMoved);
+	ItemQuantityChangedHandle = Inventory->OnInventoryItemQuantityChanged.AddUObject(this, &USIInventoryGridWidget::HandleItemChanged);
+	ItemRotatedHandle = Inventory->OnInventoryItemRotated.AddUObject(this, &USIInventoryGridWidget::HandleItemChanged);
+}
+
+void USIInventoryGridWidget::UnbindInventory()
+{
+	if (!Inventory)
+	{
+		return;
+	}
+
+	Inventory->OnInventoryItemAdded.Remove(ItemAddedHandle);
+	Inventory->OnInventoryItemRemoved.Remove(ItemRemovedHandle);
+	Inventory->OnInventoryItemMoved.Remove(ItemMovedHandle);
+	Inventory->OnInventoryItemQuantityChanged.Remove(ItemQuantityChangedHandle);
+	Inventory->OnInventoryItemRotated.Remove(ItemRotatedHandle);
+
+	for (TPair<const USIItemDefinition*, TSharedPtr<FStreamableHandle>>& Request : ThumbnailRequests)
+	{
+		if (Request.Value.IsValid())
+		{
+			Request.Value->CancelHandle();
+		}
+	}
+
+	ThumbnailRequests.Empty();
+}
+
+#undef LOCTEXT_NAMESPACE
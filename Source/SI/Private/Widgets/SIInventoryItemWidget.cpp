@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/SIInventoryItemWidget.h"
+
+#include "GameFramework/PlayerController.h"
+#include "Widgets/SIHUD.h"
+#include "Widgets/SIItemTooltipWidget.h"
+
+void USIInventoryItemWidget::SetItem(USIItem* NewItem, const FInventoryTile& NewTile)
+{
+	Item = NewItem;
+	Tile = NewTile;
+
+	OnItemUpdated();
+}
+
+void USIInventoryItemWidget::NativeOnInitialized()
+{
+	Super::NativeOnInitialized();
+
+	ToolTipWidgetDelegate.BindDynamic(this, &USIInventoryItemWidget::GetItemTooltip);
+}
+
+UWidget* USIInventoryItemWidget::GetItemTooltip()
+{
+	ASIHUD* HUD = GetOwningPlayer() ? GetOwningPlayer()->GetHUD<ASIHUD>() : nullptr;
+
+	return HUD ? HUD->GetItemTooltip(Item) : nullptr;
+}
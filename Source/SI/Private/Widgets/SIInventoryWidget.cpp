@@ -3,3 +3,262 @@
 
 #include "Widgets/SIInventoryWidget.h"
 
+#include "Blueprint/DragDropOperation.h"
+#include "Components/SIInventoryComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Items/SIItem.h"
+#include "Widgets/SIHUD.h"
+#include "Widgets/SIInventoryGridWidget.h"
+#include "Widgets/SIInventoryItemWidget.h"
+#include "Widgets/SIItemTooltipWidget.h"
+
+void USIInventoryWidget::SetInventory(USIInventoryComponent* NewInventory)
+{
+	if (NewInventory == Inventory)
+	{
+		return;
+	}
+
+	UnbindInventory();
+
+	Inventory = NewInventory;
+
+	if (InventoryGrid)
+	{
+		InventoryGrid->SetInventory(Inventory);
+	}
+
+	if (IsConstructed())
+	{
+		BindInventory();
+	}
+}
+
+bool USIInventoryWidget::GetTileAtScreenPosition(FVector2D ScreenPosition, FInventoryTile& OutTile) const
+{
+	return InventoryGrid && InventoryGrid->GetTileAtScreenPosition(ScreenPosition, OutTile);
+}
+
+void USIInventoryWidget::NativeOnInitialized()
+{
+	Super::NativeOnInitialized();
+
+	if (InventoryGrid)
+	{
+		InventoryGrid->OnHoveredTileChanged.AddDynamic(this, &USIInventoryWidget::HandleGridHoverChanged);
+		InventoryGrid->ToolTipWidgetDelegate.BindDynamic(this, &USIInventoryWidget::GetHoveredItemTooltip);
+	}
+}
+
+void USIInventoryWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (InventoryGrid)
+	{
+		InventoryGrid->SetInventory(Inventory);
+	}
+
+	BindInventory();
+}
+
+void USIInventoryWidget::NativeDestruct()
+{
+	// Stop listening while closed, the grid is synced again when it is shown
+	UnbindInventory();
+
+	Super::NativeDestruct();
+}
+
+bool USIInventoryWidget::NativeOnDragOver(const FGeometry& InGeometry, const FDragDropEvent& InDragDropEvent, UDragDropOperation* InOperation)
+{
+	const bool bHandled = Super::NativeOnDragOver(InGeometry, InDragDropEvent, InOperation);
+
+	USIItem* Item = InOperation ? Cast<USIItem>(InOperation->Payload) : nullptr;
+	FInventoryTile DropTile;
+
+	if (InventoryGrid && Inventory && Item && GetDropTile(Item, InDragDropEvent.GetScreenSpacePosition(), DropTile))
+	{
+		// Both are lookups in the cached placement mask, it is only rebuilt when the inventory or the orientation changes
+		InventoryGrid->SetPlacementHighlight(Item, false);
+		InventoryGrid->SetDragPreview(Item, DropTile, Inventory->CanPlaceItemAt(Item, DropTile, false));
+
+		return true;
+	}
+
+	if (InventoryGrid)
+	{
+		InventoryGrid->ClearDragPreview();
+		InventoryGrid->ClearPlacementHighlight();
+	}
+
+	return bHandled;
+}
+
+void USIInventoryWidget::NativeOnDragLeave(const FDragDropEvent& InDragDropEvent, UDragDropOperation* InOperation)
+{
+	Super::NativeOnDragLeave(InDragDropEvent, InOperation);
+
+	if (InventoryGrid)
+	{
+		InventoryGrid->ClearDragPreview();
+		InventoryGrid->ClearPlacementHighlight();
+	}
+}
+
+bool USIInventoryWidget::NativeOnDrop(const FGeometry& InGeometry, const FDragDropEvent& InDragDropEvent, UDragDropOperation* InOperation)
+{
+	if (InventoryGrid)
+	{
+		InventoryGrid->ClearDragPreview();
+		InventoryGrid->ClearPlacementHighlight();
+	}
+
+	return Super::NativeOnDrop(InGeometry, InDragDropEvent, InOperation);
+}
+
+bool USIInventoryWidget::GetDropTile(USIItem* Item, const FVector2D& ScreenPosition, FInventoryTile& OutTile) const
+{
+	FInventoryTile HoveredTile;
+
+	if (!Item || !GetTileAtScreenPosition(ScreenPosition, HoveredTile))
+	{
+		return false;
+	}
+
+	const FIntPoint Dimensions = Item->GetDimensions(false);
+	OutTile = FInventoryTile(HoveredTile.X - (Dimensions.X - 1) / 2, HoveredTile.Y - (Dimensions.Y - 1) / 2);
+
+	return true;
+}
+
+void USIInventoryWidget::BindInventory()
+{
+	if (!Inventory)
+	{
+		return;
+	}
+
+	ItemAddedHandle = Inventory->OnInventoryItemAdded.AddUObject(this, &USIInventoryWidget::HandleItemAdded);
+	ItemRemovedHandle = Inventory->OnInventoryItemRemoved.AddUObject(this, &USIInventoryWidget::HandleItemRemoved);
+	ItemMovedHandle = Inventory->OnInventoryItemMoved.AddUObject(this, &USIInventoryWidget::HandleItemMoved);
+	ItemQuantityChangedHandle = Inventory->OnInventoryItemQuantityChanged.AddUObject(this, &USIInventoryWidget::HandleItemChanged);
+	ItemRotatedHandle = Inventory->OnInventoryItemRotated.AddUObject(this, &USIInventoryWidget::HandleItemChanged);
+
+	SyncItemWidgets();
+}
+
+void USIInventoryWidget::UnbindInventory()
+{
+	if (!Inventory)
+	{
+		return;
+	}
+
+	Inventory->OnInventoryItemAdded.Remove(ItemAddedHandle);
+	Inventory->OnInventoryItemRemoved.Remove(ItemRemovedHandle);
+	Inventory->OnInventoryItemMoved.Remove(ItemMovedHandle);
+	Inventory->OnInventoryItemQuantityChanged.Remove(ItemQuantityChangedHandle);
+	Inventory->OnInventoryItemRotated.Remove(ItemRotatedHandle);
+}
+
+void USIInventoryWidget::SyncItemWidgets()
+{
+	TArray<USIInventoryItemWidget*> CurrentWidgets;
+	ActiveItemWidgets.GenerateValueArray(CurrentWidgets);
+	ActiveItemWidgets.Reset();
+
+	for (USIInventoryItemWidget* ItemWidget : CurrentWidgets)
+	{
+		ReleaseItemWidget(ItemWidget);
+	}
+
+	if (Inventory)
+	{
+		for (const TPair<USIItem*, FInventoryTile>& ItemTile : Inventory->GetItemsMap())
+		{
+			HandleItemAdded(ItemTile.Key, ItemTile.Value);
+		}
+	}
+}
+
+USIInventoryItemWidget* USIInventoryWidget::AcquireItemWidget()
+{
+	if (ItemWidgetPool.Num() > 0)
+	{
+		USIInventoryItemWidget* ItemWidget = ItemWidgetPool.Pop(false);
+		ItemWidget->SetVisibility(ESlateVisibility::Visible);
+
+		return ItemWidget;
+	}
+
+	return ItemWidgetClass ? CreateWidget<USIInventoryItemWidget>(this, ItemWidgetClass) : nullptr;
+}
+
+void USIInventoryWidget::ReleaseItemWidget(USIInventoryItemWidget* ItemWidget)
+{
+	if (ItemWidget)
+	{
+		ItemWidget->Item = nullptr;
+		ItemWidget->SetVisibility(ESlateVisibility::Collapsed);
+
+		OnItemWidgetReleased(ItemWidget);
+
+		ItemWidgetPool.Add(ItemWidget);
+	}
+}
+
+void USIInventoryWidget::HandleItemAdded(USIItem* Item, const FInventoryTile& Tile)
+{
+	if (!Item || ActiveItemWidgets.Contains(Item))
+	{
+		return;
+	}
+
+	if (USIInventoryItemWidget* ItemWidget = AcquireItemWidget())
+	{
+		ActiveItemWidgets.Add(Item, ItemWidget);
+
+		ItemWidget->SetItem(Item, Tile);
+		OnItemWidgetPlaced(ItemWidget, Tile);
+	}
+}
+
+void USIInventoryWidget::HandleItemRemoved(USIItem* Item, const FInventoryTile& Tile)
+{
+	USIInventoryItemWidget* ItemWidget = nullptr;
+
+	if (ActiveItemWidgets.RemoveAndCopyValue(Item, ItemWidget))
+	{
+		ReleaseItemWidget(ItemWidget);
+	}
+}
+
+void USIInventoryWidget::HandleItemMoved(USIItem* Item, const FInventoryTile& FromTile, const FInventoryTile& ToTile)
+{
+	if (USIInventoryItemWidget** ItemWidget = ActiveItemWidgets.Find(Item))
+	{
+		(*ItemWidget)->SetItem(Item, ToTile);
+		OnItemWidgetPlaced(*ItemWidget, ToTile);
+	}
+}
+
+void USIInventoryWidget::HandleItemChanged(USIItem* Item, const FInventoryTile& Tile)
+{
+	if (USIInventoryItemWidget** ItemWidget = ActiveItemWidgets.Find(Item))
+	{
+		(*ItemWidget)->SetItem(Item, Tile);
+	}
+}
+
+void USIInventoryWidget::HandleGridHoverChanged(FInventoryTile Tile, USIItem* Item, bool bHovering)
+{
+	HoveredItem = bHovering ? Item : nullptr;
+}
+
+UWidget* USIInventoryWidget::GetHoveredItemTooltip()
+{
+	ASIHUD* HUD = GetOwningPlayer() ? GetOwningPlayer()->GetHUD<ASIHUD>() : nullptr;
+
+	return HUD ? HUD->GetItemTooltip(HoveredItem) : nullptr;
+}
@@ -3,3 +3,9 @@
 
 #include "Widgets/SIItemTooltipWidget.h"
 
+void USIItemTooltipWidget::SetItem(USIItem* NewItem)
+{
+	Item = NewItem;
+
+	OnUpdateTooltip();
+}
@@ -0,0 +1,456 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/SSIInventoryGrid.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Fonts/FontMeasure.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Framework/SIThumbnailAtlasSubsystem.h"
+#include "Items/SIItem.h"
+#include "Materials/MaterialInterface.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/CoreStyle.h"
+
+void SSIInventoryGrid::Construct(const FArguments& InArgs)
+{
+	Style = InArgs._Style;
+	OnTileClicked = InArgs._OnTileClicked;
+	OnHoveredTileChanged = InArgs._OnHoveredTileChanged;
+}
+
+void SSIInventoryGrid::SetInventory(USIInventoryComponent* InInventory)
+{
+	Inventory = InInventory;
+
+	UWorld* World = InInventory ? InInventory->GetWorld() : nullptr;
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	ThumbnailAtlas = GameInstance ? GameInstance->GetSubsystem<USIThumbnailAtlasSubsystem>() : nullptr;
+
+	DragPreview.Reset();
+	PlacementHighlight.Empty();
+	RefreshItems();
+}
+
+void SSIInventoryGrid::SetStyle(const FSIInventoryGridStyle& InStyle)
+{
+	Style = InStyle;
+
+	// The stack count sizes depend on the font
+	for (FGridItem& GridItem : GridItems)
+	{
+		CacheItem(GridItem, GridItem.Item.Get(), GridItem.Tile);
+	}
+
+	bItemBucketsDirty = true;
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SSIInventoryGrid::RefreshItems()
+{
+	GridItems.Reset();
+
+	if (USIInventoryComponent* InventoryPtr = Inventory.Get())
+	{
+		for (const TPair<USIItem*, FInventoryTile>& ItemTile : InventoryPtr->GetItemsMap())
+		{
+			CacheItem(GridItems.AddDefaulted_GetRef(), ItemTile.Key, ItemTile.Value);
+		}
+	}
+
+	bItemBucketsDirty = true;
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SSIInventoryGrid::UpdateItem(USIItem* Item, const FInventoryTile& Tile)
+{
+	FGridItem* GridItem = GridItems.FindByPredicate([Item](const FGridItem& Other)
+	{
+		return Other.Item.Get() == Item;
+	});
+
+	CacheItem(GridItem ? *GridItem : GridItems.AddDefaulted_GetRef(), Item, Tile);
+
+	bItemBucketsDirty = true;
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SSIInventoryGrid::RemoveItem(USIItem* Item)
+{
+	const int32 Index = GridItems.IndexOfByPredicate([Item](const FGridItem& Other)
+	{
+		return Other.Item.Get() == Item;
+	});
+
+	if (Index != INDEX_NONE)
+	{
+		GridItems.RemoveAtSwap(Index, 1, false);
+
+		bItemBucketsDirty = true;
+		Invalidate(EInvalidateWidgetReason::Paint);
+	}
+}
+
+void SSIInventoryGrid::SetDragPreview(USIItem* Item, const FInventoryTile& Tile, const bool bValid)
+{
+	FDragPreview NewPreview;
+	NewPreview.Item = Item;
+	NewPreview.Tile = Tile;
+	NewPreview.bValid = bValid;
+
+	DragPreview = NewPreview;
+
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SSIInventoryGrid::ClearDragPreview()
+{
+	if (DragPreview.IsSet())
+	{
+		DragPreview.Reset();
+
+		Invalidate(EInvalidateWidgetReason::Paint);
+	}
+}
+
+void SSIInventoryGrid::SetPlacementHighlight(const TBitArray<>& InPlacementMask)
+{
+	PlacementHighlight = InPlacementMask;
+
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SSIInventoryGrid::ClearPlacementHighlight()
+{
+	if (PlacementHighlight.Num() > 0)
+	{
+		PlacementHighlight.Empty();
+
+		Invalidate(EInvalidateWidgetReason::Paint);
+	}
+}
+
+bool SSIInventoryGrid::GetTileAtPosition(const FGeometry& Geometry, const FVector2D& ScreenPosition, FInventoryTile& OutTile) const
+{
+	const USIInventoryComponent* InventoryPtr = Inventory.Get();
+
+	if (!InventoryPtr)
+	{
+		return false;
+	}
+
+	const FVector2D LocalPosition = Geometry.AbsoluteToLocal(ScreenPosition);
+	const FInventoryTile Tile(FMath::FloorToInt(LocalPosition.X / Style.TileSize), FMath::FloorToInt(LocalPosition.Y / Style.TileSize));
+
+	if (!InventoryPtr->IsTileValid(Tile))
+	{
+		return false;
+	}
+
+	OutTile = Tile;
+
+	return true;
+}
+
+void SSIInventoryGrid::CacheItem(FGridItem& GridItem, USIItem* Item, const FInventoryTile& Tile) const
+{
+	GridItem.Item = Item;
+	GridItem.Tile = Tile;
+	GridItem.Dimensions = Item ? Item->GetDimensions() : FIntPoint(1, 1);
+	GridItem.bRotated = Item && Item->GetRotated();
+	GridItem.QuantityText.Reset();
+	GridItem.QuantityTextSize = FVector2D::ZeroVector;
+
+	if (Item && Item->GetQuantity() > 1)
+	{
+		GridItem.QuantityText = FString::FromInt(Item->GetQuantity());
+
+		// Measured here rather than every paint, it only changes with the quantity
+		if (FSlateApplication::IsInitialized())
+		{
+			GridItem.QuantityTextSize = FSlateApplication::Get().GetRenderer()->GetFontMeasureService()->Measure(GridItem.QuantityText, Style.StackCountFont);
+		}
+	}
+}
+
+const FSlateBrush* SSIInventoryGrid::GetThumbnailBrush(const USIItem* Item) const
+{
+	UMaterialInterface* Thumbnail = Item ? Item->GetThumbnailAsset().Get() : nullptr;
+
+	if (!Thumbnail)
+	{
+		return nullptr;
+	}
+
+	if (const USIThumbnailAtlasSubsystem* Atlas = ThumbnailAtlas.Get())
+	{
+		if (const FSlateBrush* AtlasBrush = Atlas->FindThumbnailBrush(Thumbnail))
+		{
+			return AtlasBrush;
+		}
+	}
+
+	if (const FSlateBrush* Brush = ThumbnailBrushes.Find(Thumbnail))
+	{
+		return Brush;
+	}
+
+	FSlateBrush& Brush = ThumbnailBrushes.Add(Thumbnail);
+	Brush.SetResourceObject(Thumbnail);
+	Brush.DrawAs = ESlateBrushDrawType::Image;
+
+	return &Brush;
+}
+
+void SSIInventoryGrid::DrawThumbnail(FSlateWindowElementList& OutDrawElements, int32 LayerId, const FGeometry& AllottedGeometry, const FSlateBrush* Brush, const FVector2D& Position, const FVector2D& Size, const bool bRotated, ESlateDrawEffect DrawEffects, const FLinearColor& Tint) const
+{
+	if (!bRotated)
+	{
+		FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(Position, Size), Brush, DrawEffects, Tint);
+		return;
+	}
+
+	// Lay the unrotated image over the same center and turn it around that center
+	const FVector2D UnrotatedSize(Size.Y, Size.X);
+	const FVector2D UnrotatedPosition = Position + (Size - UnrotatedSize) * 0.5f;
+
+	FSlateDrawElement::MakeRotatedBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(UnrotatedPosition, UnrotatedSize), Brush, DrawEffects, HALF_PI, TOptional<FVector2D>(), FSlateDrawElement::RelativeToElement, Tint);
+}
+
+void SSIInventoryGrid::RebuildItemBuckets() const
+{
+	ItemBuckets.Reset();
+	MaxItemExtent = 1;
+
+	for (int32 GridItemIndex = 0; GridItemIndex < GridItems.Num(); GridItemIndex++)
+	{
+		const FGridItem& GridItem = GridItems[GridItemIndex];
+
+		ItemBuckets.FindOrAdd(FIntPoint(GridItem.Tile.X / BucketSize, GridItem.Tile.Y / BucketSize)).Add(GridItemIndex);
+		MaxItemExtent = FMath::Max3(MaxItemExtent, GridItem.Dimensions.X, GridItem.Dimensions.Y);
+	}
+
+	bItemBucketsDirty = false;
+}
+
+FVector2D SSIInventoryGrid::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	if (const USIInventoryComponent* InventoryPtr = Inventory.Get())
+	{
+		return FVector2D(InventoryPtr->Columns, InventoryPtr->Rows) * Style.TileSize;
+	}
+
+	return FVector2D::ZeroVector;
+}
+
+int32 SSIInventoryGrid::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	const USIInventoryComponent* InventoryPtr = Inventory.Get();
+
+	if (!InventoryPtr || InventoryPtr->Columns <= 0 || InventoryPtr->Rows <= 0)
+	{
+		return LayerId;
+	}
+
+	const float TileSize = Style.TileSize;
+	const ESlateDrawEffect DrawEffects = ShouldBeEnabled(bParentEnabled) ? ESlateDrawEffect::None : ESlateDrawEffect::DisabledEffect;
+	const FLinearColor Tint = InWidgetStyle.GetColorAndOpacityTint();
+
+	// Work out which tiles are visible, anything outside of them is skipped entirely
+	const FVector2D VisibleTopLeft = AllottedGeometry.AbsoluteToLocal(MyCullingRect.GetTopLeft());
+	const FVector2D VisibleBottomRight = AllottedGeometry.AbsoluteToLocal(MyCullingRect.GetBottomRight());
+
+	const int32 MinColumn = FMath::Clamp(FMath::FloorToInt(VisibleTopLeft.X / TileSize), 0, InventoryPtr->Columns);
+	const int32 MaxColumn = FMath::Clamp(FMath::CeilToInt(VisibleBottomRight.X / TileSize), 0, InventoryPtr->Columns);
+	const int32 MinRow = FMath::Clamp(FMath::FloorToInt(VisibleTopLeft.Y / TileSize), 0, InventoryPtr->Rows);
+	const int32 MaxRow = FMath::Clamp(FMath::CeilToInt(VisibleBottomRight.Y / TileSize), 0, InventoryPtr->Rows);
+
+	if (MinColumn >= MaxColumn || MinRow >= MaxRow)
+	{
+		return LayerId;
+	}
+
+	const FVector2D VisibleMin(MinColumn * TileSize, MinRow * TileSize);
+	const FVector2D VisibleMax(MaxColumn * TileSize, MaxRow * TileSize);
+
+	// Background
+	if (Style.Background.DrawAs != ESlateBrushDrawType::NoDrawType)
+	{
+		FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(VisibleMin, VisibleMax - VisibleMin), &Style.Background, DrawEffects, Style.Background.GetTint(InWidgetStyle) * Tint);
+	}
+
+	// Valid drop zones of the dragged item
+	if (PlacementHighlight.Num() == InventoryPtr->Columns * InventoryPtr->Rows)
+	{
+		const FSlateBrush* HighlightBrush = FCoreStyle::Get().GetBrush("GenericWhiteBox");
+
+		for (int32 Row = MinRow; Row < MaxRow; Row++)
+		{
+			for (int32 Column = MinColumn; Column < MaxColumn; Column++)
+			{
+				if (PlacementHighlight[InventoryPtr->TileToIndex(FInventoryTile(Column, Row))])
+				{
+					FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(FVector2D(Column, Row) * TileSize, FVector2D(TileSize, TileSize)), HighlightBrush, DrawEffects, Style.PlacementHighlightColor * Tint);
+				}
+			}
+		}
+	}
+
+	// Grid lines. Each direction is a single zigzag polyline, the segments joining two lines run along the border, which is a grid line anyway
+	if (Style.GridLineThickness > 0.f)
+	{
+		LinePoints.Reset();
+
+		for (int32 Column = MinColumn; Column <= MaxColumn; Column++)
+		{
+			const bool bDownwards = (Column - MinColumn) % 2 == 0;
+
+			LinePoints.Add(FVector2D(Column * TileSize, bDownwards ? VisibleMin.Y : VisibleMax.Y));
+			LinePoints.Add(FVector2D(Column * TileSize, bDownwards ? VisibleMax.Y : VisibleMin.Y));
+		}
+
+		FSlateDrawElement::MakeLines(OutDrawElements, LayerId + 1, AllottedGeometry.ToPaintGeometry(), LinePoints, DrawEffects, Style.GridLineColor * Tint, false, Style.GridLineThickness);
+
+		LinePoints.Reset();
+
+		for (int32 Row = MinRow; Row <= MaxRow; Row++)
+		{
+			const bool bRightwards = (Row - MinRow) % 2 == 0;
+
+			LinePoints.Add(FVector2D(bRightwards ? VisibleMin.X : VisibleMax.X, Row * TileSize));
+			LinePoints.Add(FVector2D(bRightwards ? VisibleMax.X : VisibleMin.X, Row * TileSize));
+		}
+
+		FSlateDrawElement::MakeLines(OutDrawElements, LayerId + 1, AllottedGeometry.ToPaintGeometry(), LinePoints, DrawEffects, Style.GridLineColor * Tint, false, Style.GridLineThickness);
+	}
+
+	// Items and their stack counts. Only the buckets that can reach the visible tiles are walked, an item reaches at most
+	// MaxItemExtent - 1 tiles right and down of the bucket its anchor is in
+	if (bItemBucketsDirty)
+	{
+		RebuildItemBuckets();
+	}
+
+	const int32 MinBucketX = FMath::Max(0, MinColumn - MaxItemExtent + 1) / BucketSize;
+	const int32 MinBucketY = FMath::Max(0, MinRow - MaxItemExtent + 1) / BucketSize;
+	const int32 MaxBucketX = (MaxColumn - 1) / BucketSize;
+	const int32 MaxBucketY = (MaxRow - 1) / BucketSize;
+
+	for (int32 BucketY = MinBucketY; BucketY <= MaxBucketY; BucketY++)
+	{
+		for (int32 BucketX = MinBucketX; BucketX <= MaxBucketX; BucketX++)
+		{
+			const TArray<int32>* Bucket = ItemBuckets.Find(FIntPoint(BucketX, BucketY));
+
+			if (!Bucket)
+			{
+				continue;
+			}
+
+			for (const int32 GridItemIndex : *Bucket)
+			{
+				const FGridItem& GridItem = GridItems[GridItemIndex];
+				const USIItem* Item = GridItem.Item.Get();
+
+				if (!Item)
+				{
+					continue;
+				}
+
+				const FVector2D ItemMin(GridItem.Tile.X * TileSize, GridItem.Tile.Y * TileSize);
+				const FVector2D ItemSize(GridItem.Dimensions.X * TileSize, GridItem.Dimensions.Y * TileSize);
+				const FVector2D ItemMax = ItemMin + ItemSize;
+
+				if (ItemMax.X <= VisibleMin.X || ItemMax.Y <= VisibleMin.Y || ItemMin.X >= VisibleMax.X || ItemMin.Y >= VisibleMax.Y)
+				{
+					continue;
+				}
+
+				if (const FSlateBrush* ThumbnailBrush = GetThumbnailBrush(Item))
+				{
+					DrawThumbnail(OutDrawElements, LayerId + 2, AllottedGeometry, ThumbnailBrush, ItemMin, ItemSize, GridItem.bRotated, DrawEffects, Tint);
+				}
+
+				if (!GridItem.QuantityText.IsEmpty())
+				{
+					const FVector2D TextPosition = ItemMax - GridItem.QuantityTextSize - Style.StackCountPadding;
+
+					FSlateDrawElement::MakeText(OutDrawElements, LayerId + 3, AllottedGeometry.ToPaintGeometry(TextPosition, GridItem.QuantityTextSize), GridItem.QuantityText, Style.StackCountFont, DrawEffects, Style.StackCountColor * Tint);
+				}
+			}
+		}
+	}
+
+	// Drag preview, the tiles the item would cover tinted by whether it fits, with the thumbnail on top
+	if (DragPreview.IsSet())
+	{
+		if (const USIItem* PreviewItem = DragPreview->Item.Get())
+		{
+			const FIntPoint Dimensions = PreviewItem->GetDimensions(false);
+			const FVector2D PreviewMin(DragPreview->Tile.X * TileSize, DragPreview->Tile.Y * TileSize);
+			const FVector2D PreviewSize(Dimensions.X * TileSize, Dimensions.Y * TileSize);
+			const FLinearColor& PlacementColor = DragPreview->bValid ? Style.ValidPlacementColor : Style.InvalidPlacementColor;
+
+			FSlateDrawElement::MakeBox(OutDrawElements, LayerId + 4, AllottedGeometry.ToPaintGeometry(PreviewMin, PreviewSize), FCoreStyle::Get().GetBrush("GenericWhiteBox"), DrawEffects, PlacementColor * Tint);
+
+			if (const FSlateBrush* ThumbnailBrush = GetThumbnailBrush(PreviewItem))
+			{
+				DrawThumbnail(OutDrawElements, LayerId + 4, AllottedGeometry, ThumbnailBrush, PreviewMin, PreviewSize, PreviewItem->GetNewRotated(), DrawEffects, Tint.CopyWithNewOpacity(Tint.A * 0.6f));
+			}
+		}
+	}
+
+	return LayerId + 4;
+}
+
+FReply SSIInventoryGrid::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	FInventoryTile Tile;
+
+	if (OnTileClicked.IsBound() && GetTileAtPosition(MyGeometry, MouseEvent.GetScreenSpacePosition(), Tile))
+	{
+		return OnTileClicked.Execute(Tile, MouseEvent);
+	}
+
+	return FReply::Unhandled();
+}
+
+FReply SSIInventoryGrid::OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	FInventoryTile Tile;
+
+	if (GetTileAtPosition(MyGeometry, MouseEvent.GetScreenSpacePosition(), Tile))
+	{
+		if (!HoveredTile.IsSet() || HoveredTile->X != Tile.X || HoveredTile->Y != Tile.Y)
+		{
+			HoveredTile = Tile;
+			OnHoveredTileChanged.ExecuteIfBound(Tile, true);
+		}
+	}
+	else if (HoveredTile.IsSet())
+	{
+		OnHoveredTileChanged.ExecuteIfBound(HoveredTile.GetValue(), false);
+		HoveredTile.Reset();
+	}
+
+	return FReply::Unhandled();
+}
+
+void SSIInventoryGrid::OnMouseLeave(const FPointerEvent& MouseEvent)
+{
+	SLeafWidget::OnMouseLeave(MouseEvent);
+
+	if (HoveredTile.IsSet())
+	{
+		OnHoveredTileChanged.ExecuteIfBound(HoveredTile.GetValue(), false);
+		HoveredTile.Reset();
+	}
+}
+
+void SSIInventoryGrid::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	// Keep the thumbnails we hold our own brushes for alive, the brush only stores a raw pointer to them
+	Collector.AddReferencedObjects(ThumbnailBrushes);
+}
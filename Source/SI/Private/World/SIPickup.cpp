@@ -3,14 +3,19 @@
 
 #include "World/SIPickup.h"
 
+#include "Components/BoxComponent.h"
 #include "Components/SIInteractionComponent.h"
 #include "Components/SIInventoryComponent.h"
 #include "Engine/ActorChannel.h"
+#include "Engine/StaticMesh.h"
+#include "Framework/SIInteractionSubsystem.h"
 #include "Items/SIItem.h"
 #include "Library/SIInventoryStructLibrary.h"
 #include "Net/UnrealNetwork.h"
 #include "Player/SICharacter.h"
 #include "Player/SIPlayerController.h"
+#include "SI.h"
+#include "World/SIPickupSubsystem.h"
 
 ASIPickup::ASIPickup()
 {
@@ -19,13 +24,18 @@ ASIPickup::ASIPickup()
 
 	SetRootComponent(PickupMesh);
 
+	InteractionCollision = CreateDefaultSubobject<UBoxComponent>("InteractionCollision");
+	InteractionCollision->SetupAttachment(PickupMesh);
+	InteractionCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	InteractionCollision->SetCollisionResponseToAllChannels(ECR_Ignore);
+	InteractionCollision->SetCollisionResponseToChannel(COLLISION_INTERACTION, ECR_Block);
+
 	InteractionComponent = CreateDefaultSubobject<USIInteractionComponent>("PickupInteractionComponent");
 	InteractionComponent->InteractionTime = 0.f;
 	InteractionComponent->InteractionDistance = 500.f;
 	InteractionComponent->InteractableNameText = FText::FromString("Pickup");
 	InteractionComponent->InteractableActionText = FText::FromString("Take");
 	InteractionComponent->OnInteract.AddDynamic(this, &ASIPickup::OnTakePickup);
-	InteractionComponent->SetupAttachment(PickupMesh);
 
 	bReplicates = true;
 }
@@ -62,8 +72,29 @@ void ASIPickup::OnRep_Item()
 {
 	if (Item)
 	{
-		PickupMesh->SetStaticMesh(Item->PickupMesh);
-		InteractionComponent->InteractableNameText = Item->DisplayName;
+		if (PickupMeshHandle.IsValid())
+		{
+			PickupMeshHandle->CancelHandle();
+			PickupMeshHandle.Reset();
+		}
+
+		if (GetNetMode() == NM_DedicatedServer)
+		{
+			// Item meshes stay out of server memory, a box the size of the item is all the interaction traces need
+			const FIntPoint Dimensions = Item->GetBaseDimensions();
+			const FVector Extent = FVector(Dimensions.X * CollisionTileSize, Dimensions.Y * CollisionTileSize, CollisionHeight) * 0.5f;
+
+			InteractionCollision->SetBoxExtent(Extent);
+			InteractionCollision->SetRelativeLocation(FVector(0.f, 0.f, Extent.Z));
+			InteractionCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		}
+		else
+		{
+			// Request the mesh now that the pickup is relevant
+			PickupMeshHandle = Item->RequestPickupMesh(FStreamableDelegate::CreateUObject(this, &ASIPickup::OnPickupMeshLoaded));
+		}
+
+		InteractionComponent->InteractableNameText = Item->GetDisplayName();
 
 		// Clients bind to this delegate in order to refresh the interaction widget if item quantity changes (not takes all)
 		Item->OnItemModified.AddDynamic(this, &ASIPickup::OnItemModified);
@@ -72,6 +103,14 @@ void ASIPickup::OnRep_Item()
 	InteractionComponent->RefreshWidget();
 }
 
+void ASIPickup::OnPickupMeshLoaded()
+{
+	if (Item)
+	{
+		PickupMesh->SetStaticMesh(Item->GetPickupMesh().Get());
+	}
+}
+
 void ASIPickup::OnItemModified()
 {
 	if (InteractionComponent)
@@ -91,7 +130,23 @@ void ASIPickup::BeginPlay()
 
 	if (!bNetStartup)
 	{
-		AlignWithGround();
+		USIPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<USIPickupSubsystem>();
+
+		// The Blueprint event only runs for classes that opted out of the batched traces
+		if (bUseNativeGroundAlignment && PickupSubsystem)
+		{
+			PickupSubsystem->RequestGroundAlignment(this);
+		}
+		else
+		{
+			AlignWithGround();
+		}
+
+		// Pickups placed in the level stay, dropped ones get cleaned up once they expire
+		if (HasAuthority() && PickupSubsystem)
+		{
+			PickupSubsystem->RegisterDroppedPickup(this);
+		}
 	}
 
 	if (Item)
@@ -100,6 +155,38 @@ void ASIPickup::BeginPlay()
 	}
 }
 
+void ASIPickup::ApplyGroundAlignment(const FHitResult& GroundHit)
+{
+	// Keep the pickup's yaw, only tilt it so it rests on the surface
+	const FRotator GroundRotation = FRotationMatrix::MakeFromZX(GroundHit.ImpactNormal, GetActorForwardVector()).Rotator();
+
+	SetActorLocationAndRotation(GroundHit.ImpactPoint, GroundRotation, false, nullptr, ETeleportType::TeleportPhysics);
+
+	if (USIInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<USIInteractionSubsystem>())
+	{
+		InteractionSubsystem->UpdateInteractable(InteractionComponent);
+	}
+}
+
+void ASIPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (HasAuthority() && !bNetStartup)
+	{
+		if (USIPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<USIPickupSubsystem>())
+		{
+			PickupSubsystem->UnregisterDroppedPickup(this);
+		}
+	}
+
+	if (PickupMeshHandle.IsValid())
+	{
+		PickupMeshHandle->CancelHandle();
+		PickupMeshHandle.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ASIPickup::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -131,7 +218,7 @@ void ASIPickup::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEve
 	{
 		if (ItemTemplate)
 		{
-			PickupMesh->SetStaticMesh(ItemTemplate->PickupMesh);
+			PickupMesh->SetStaticMesh(ItemTemplate->GetPickupMesh().LoadSynchronous());
 		}
 	}
 }
@@ -148,24 +235,14 @@ void ASIPickup::OnTakePickup(ASICharacter* Taker)
 	// Not 100% sure Pending kill check is needed but should prevent player from taking a pickup another player has already tried taking
 	if (HasAuthority() && !IsPendingKillPending() && Item)
 	{
-		FSIItemAddResult AddResult;
-		
-		// for (auto& Inventory : Taker->GetInventoryList()) // TODO: Update for taking all inventories
-		if (USIInventoryComponent* Inventory = Taker->GetInventoryComponent())
-		{
-			AddResult = Inventory->TryAddItem(Item, FInventoryTile());
+		// The item is left with whatever didn't fit
+		const FSIItemAddResult AddResult = Taker->TryAddItemToInventories(Item);
 
-			if (AddResult.AmountGiven >= Item->GetQuantity())
-			{
-				Destroy();
+		if (AddResult.AmountGiven >= AddResult.AmountToGive)
+		{
+			Destroy();
 
-				return;
-			}
-			
-			if (AddResult.AmountGiven < Item->GetQuantity())
-			{
-				Item->SetQuantity(Item->GetQuantity() - AddResult.AmountGiven);
-			}
+			return;
 		}
 
 		if (!AddResult.ErrorText.IsEmpty())
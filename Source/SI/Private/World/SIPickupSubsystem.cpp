@@ -0,0 +1,257 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "World/SIPickupSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "World/SIPickup.h"
+
+void USIPickupSubsystem::Deinitialize()
+{
+	DroppedPickups.Empty();
+	ExpiryCursor = 0;
+
+	PendingGroundAlignments.Empty();
+	GroundAlignmentTraces.Empty();
+
+	Super::Deinitialize();
+}
+
+void USIPickupSubsystem::Tick(float DeltaTime)
+{
+	if (UWorld* World = GetWorld())
+	{
+		TickGroundAlignment(World);
+		TickLifetime(World);
+	}
+}
+
+void USIPickupSubsystem::TickLifetime(UWorld* World)
+{
+	if (DroppedPickups.Num() == 0)
+	{
+		return;
+	}
+
+	const float Now = World->GetTimeSeconds();
+	int32 Budget = MaxPickupsCheckedPerFrame;
+
+	TArray<FSIPickupViewer, TInlineAllocator<8>> Viewers;
+	GatherViewers(Viewers);
+
+	// Over the cap, evict the oldest pickups nobody is looking at. If all of the ones we looked at are visible, the oldest goes anyway
+	while (Budget > 0 && DroppedPickups.Num() > MaxDroppedPickups)
+	{
+		int32 EvictIndex = 0;
+		const int32 SearchEnd = FMath::Min(Budget, DroppedPickups.Num());
+
+		for (int32 Index = 0; Index < SearchEnd; Index++)
+		{
+			Budget--;
+
+			const ASIPickup* Pickup = DroppedPickups[Index].Pickup.Get();
+
+			if (!Pickup || !IsVisibleToAnyViewer(Pickup, Viewers))
+			{
+				EvictIndex = Index;
+				break;
+			}
+		}
+
+		DespawnPickupAt(EvictIndex);
+	}
+
+	// Expired pickups are a prefix of the array, so walk it from the cursor until we reach one that is still alive
+	while (Budget > 0 && DroppedPickups.Num() > 0)
+	{
+		Budget--;
+
+		if (!DroppedPickups.IsValidIndex(ExpiryCursor))
+		{
+			ExpiryCursor = 0;
+		}
+
+		const FSIDroppedPickup& Entry = DroppedPickups[ExpiryCursor];
+		const float Age = Now - Entry.DropTime;
+
+		if (Age < PickupLifetime)
+		{
+			// Everything after this one was dropped later, start again from the oldest next frame
+			ExpiryCursor = 0;
+			break;
+		}
+
+		const ASIPickup* Pickup = Entry.Pickup.Get();
+
+		if (!Pickup || Age >= PickupLifetime + MaxVisibleLifetimeExtension || !IsVisibleToAnyViewer(Pickup, Viewers))
+		{
+			DespawnPickupAt(ExpiryCursor);
+		}
+		else
+		{
+			ExpiryCursor++;
+		}
+	}
+}
+
+void USIPickupSubsystem::TickGroundAlignment(UWorld* World)
+{
+	// Apply the results of the traces issued last frame
+	for (int32 Index = GroundAlignmentTraces.Num() - 1; Index >= 0; Index--)
+	{
+		const FSIGroundAlignmentTrace& Trace = GroundAlignmentTraces[Index];
+		FTraceDatum Datum;
+
+		if (World->QueryTraceData(Trace.Handle, Datum))
+		{
+			if (ASIPickup* Pickup = Trace.Pickup.Get())
+			{
+				const FHitResult* GroundHit = Datum.OutHits.FindByPredicate([](const FHitResult& Hit)
+				{
+					return Hit.bBlockingHit;
+				});
+
+				if (GroundHit)
+				{
+					Pickup->ApplyGroundAlignment(*GroundHit);
+				}
+			}
+
+			GroundAlignmentTraces.RemoveAtSwap(Index, 1, false);
+		}
+		else if (!World->IsTraceHandleValid(Trace.Handle, false))
+		{
+			GroundAlignmentTraces.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	// Issue this frame's batch, whatever is over budget waits for the next frame
+	const int32 NumToIssue = FMath::Min(PendingGroundAlignments.Num(), MaxGroundTracesPerFrame);
+
+	for (int32 Index = 0; Index < NumToIssue; Index++)
+	{
+		if (ASIPickup* Pickup = PendingGroundAlignments[Index].Get())
+		{
+			const FVector Location = Pickup->GetActorLocation();
+			const FVector TraceStart = Location + FVector(0.f, 0.f, GroundTraceUpOffset);
+			const FVector TraceEnd = Location - FVector(0.f, 0.f, GroundTraceDistance);
+
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SIPickupGroundAlignment), false, Pickup);
+
+			FSIGroundAlignmentTrace& Trace = GroundAlignmentTraces.AddDefaulted_GetRef();
+			Trace.Pickup = Pickup;
+			Trace.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, ECC_Visibility, QueryParams);
+		}
+	}
+
+	PendingGroundAlignments.RemoveAt(0, NumToIssue, false);
+}
+
+bool USIPickupSubsystem::IsTickable() const
+{
+	return DroppedPickups.Num() > 0 || PendingGroundAlignments.Num() > 0 || GroundAlignmentTraces.Num() > 0;
+}
+
+ETickableTickType USIPickupSubsystem::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId USIPickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USIPickupSubsystem, STATGROUP_Tickables);
+}
+
+void USIPickupSubsystem::RegisterDroppedPickup(ASIPickup* Pickup)
+{
+	if (Pickup && GetWorld())
+	{
+		DroppedPickups.Add(FSIDroppedPickup(Pickup, GetWorld()->GetTimeSeconds()));
+	}
+}
+
+void USIPickupSubsystem::UnregisterDroppedPickup(ASIPickup* Pickup)
+{
+	const int32 Index = DroppedPickups.IndexOfByPredicate([Pickup](const FSIDroppedPickup& Entry)
+	{
+		return Entry.Pickup.Get() == Pickup;
+	});
+
+	if (Index != INDEX_NONE)
+	{
+		DroppedPickups.RemoveAt(Index, 1, false);
+
+		if (Index < ExpiryCursor)
+		{
+			ExpiryCursor--;
+		}
+	}
+}
+
+void USIPickupSubsystem::RequestGroundAlignment(ASIPickup* Pickup)
+{
+	if (Pickup)
+	{
+		PendingGroundAlignments.Add(Pickup);
+	}
+}
+
+void USIPickupSubsystem::GatherViewers(TArray<FSIPickupViewer, TInlineAllocator<8>>& OutViewers) const
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (APlayerController* PC = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			OutViewers.Add({ ViewLocation, ViewRotation.Vector() });
+		}
+	}
+}
+
+bool USIPickupSubsystem::IsVisibleToAnyViewer(const ASIPickup* Pickup, const TArray<FSIPickupViewer, TInlineAllocator<8>>& Viewers) const
+{
+	const FVector PickupLocation = Pickup->GetActorLocation();
+	const float MaxDistanceSquared = FMath::Square(VisibilityDistance);
+	const float MinDot = FMath::Cos(FMath::DegreesToRadians(VisibilityHalfAngle));
+
+	for (const FSIPickupViewer& Viewer : Viewers)
+	{
+		const FVector ToPickup = PickupLocation - Viewer.Location;
+		const float DistanceSquared = ToPickup.SizeSquared();
+
+		if (DistanceSquared > MaxDistanceSquared)
+		{
+			continue;
+		}
+
+		if (DistanceSquared <= KINDA_SMALL_NUMBER || FVector::DotProduct(ToPickup * FMath::InvSqrt(DistanceSquared), Viewer.Direction) >= MinDot)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void USIPickupSubsystem::DespawnPickupAt(const int32 Index)
+{
+	ASIPickup* Pickup = DroppedPickups[Index].Pickup.Get();
+
+	// Remove the entry first, the pickup unregistering itself on EndPlay will then be a no-op
+	DroppedPickups.RemoveAt(Index, 1, false);
+
+	if (Index < ExpiryCursor)
+	{
+		ExpiryCursor--;
+	}
+
+	if (Pickup && !Pickup->IsPendingKillPending())
+	{
+		Pickup->Destroy();
+	}
+}
@@ -3,7 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Components/WidgetComponent.h"
+#include "Components/ActorComponent.h"
 #include "SIInteractionComponent.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBeginInteract, class ASICharacter*, Character);
@@ -13,10 +13,11 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEndFocus, class ASICharacter*, Ch
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInteract, class ASICharacter*, Character);
 
 /**
- * 
+ * Interaction data of an actor. It has no presentation of its own, the focused interactable is shown
+ * by the single interaction prompt owned by ASIHUD.
  */
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
-class SI_API USIInteractionComponent : public UWidgetComponent
+class SI_API USIInteractionComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
@@ -44,6 +45,12 @@ class SI_API USIInteractionComponent : public UWidgetComponent
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
 	bool bAllowMultipleInteractors;
 
+	//Where the interaction prompt is shown, relative to the owner's location
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	FVector PromptOffset;
+
+	FORCEINLINE FVector GetPromptLocation() const { return GetOwner() ? GetOwner()->GetActorLocation() + PromptOffset : PromptOffset; }
+
 	//Call this to change the name of the interactable. Will also refresh the interaction widget.
 	UFUNCTION(BlueprintCallable, Category = "Interaction")
 	void SetInteractableNameText(const FText& NewNameText);
@@ -78,15 +85,27 @@ protected:
 	// Called when the game starts
 	virtual void Deactivate() override;
 
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	bool CanInteract(class ASICharacter* Character) const;
 
 	//On the server, this will hold all interactors. On the local player, this will just hold the local player (provided they are an interactor)
 	UPROPERTY()
 	TArray<class ASICharacter*> Interactors;
 
+	//The owner's primitives that get outlined while focused, gathered once when this component registers
+	UPROPERTY(Transient)
+	TArray<class UPrimitiveComponent*> HighlightPrimitives;
+
+	bool bHighlighted = false;
+
+	//The HUD of the character if it is locally controlled, that's where the interaction prompt lives
+	class ASIHUD* GetLocalHUD(class ASICharacter* Character) const;
+
 public:
 
-	/***Refresh the interaction widget and its custom widgets.
+	/***Refresh the interaction prompt if it is showing this interactable.
 	An example of when we'd use this is when we take 3 items out of a stack of 10, and we need to update the widget
 	so it shows the stack as having 7 items left. */
 	void RefreshWidget();
@@ -101,9 +120,22 @@ public:
 
 	void Interact(class ASICharacter* Character) const;
 
+	//Turns the focus outline on or off. Does nothing if it is already in that state
+	void SetHighlighted(const bool bNewHighlighted);
+
+	//Gathers the owner's primitives again, call this after adding or removing components at runtime
+	void RefreshHighlightPrimitives();
+
 	//Return a value from 0-1 denoting how far through the interact we are. 
 	//On server this is the first interactors percentage, on client this is the local interactors percentage
 	UFUNCTION(BlueprintPure, Category = "Interaction")
-	float GetInteractPercentage();
+	FORCEINLINE float GetInteractPercentage() const { return InteractProgress; }
+
+	//Called by the interaction subsystem as a hold to interact advances. Pushes the progress to the widget
+	void SetInteractProgress(class ASICharacter* Character, const float NewProgress);
+
+protected:
+
+	float InteractProgress = 0.f;
 	
 };
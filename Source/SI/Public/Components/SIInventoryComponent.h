@@ -4,7 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Engine/StreamableManager.h"
 #include "Library/SIInventoryStructLibrary.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "SIInventoryCore.h"
 #include "SIInventoryComponent.generated.h"
 
 //Called when the inventory is changed and the UI needs an update. 
@@ -14,12 +17,90 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnInventoryUpdated);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnItemAdded, class USIItem*, Item);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnItemRemoved, class USIItem*, Item);
 
+/**Fine grained changes, fired on server and clients alike with the item and the tile it is anchored at*/
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnInventoryItemChanged, class USIItem* /*Item*/, const FInventoryTile& /*Tile*/);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnInventoryItemMoved, class USIItem* /*Item*/, const FInventoryTile& /*FromTile*/, const FInventoryTile& /*ToTile*/);
+
+/**An 8x8 block of tiles of a chunked inventory. Chunks only exist while something is in them*/
+USTRUCT()
+struct FSIInventoryChunk : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	FSIInventoryChunk() { FMemory::Memzero(Cells); };
+
+	//Position of the chunk, in chunks from the top left of the grid
+	UPROPERTY()
+	FIntPoint Coord = FIntPoint::ZeroValue;
+
+	//USIInventoryComponent::ChunkSize squared cells, row by row
+	UPROPERTY()
+	class USIItem* Cells[64];
+
+	bool IsEmpty() const;
+};
+
+USTRUCT()
+struct FSIInventoryChunkArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FSIInventoryChunk> Chunks;
+
+	UPROPERTY(NotReplicated)
+	class USIInventoryComponent* Owner = nullptr;
+
+	//Runs once per received update, after every chunk in it was applied
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FSIInventoryChunk, FSIInventoryChunkArray>(Chunks, DeltaParms, *this);
+	}
+};
+
+/**What the inventory router needs to know about an inventory to pick it, without searching its grid*/
+struct FSIInventoryRoutingSummary
+{
+	int32 FreeTiles = 0;
+
+	//Widest empty rectangle at least Index + 1 tiles tall, so anything up to that size fits somewhere
+	TArray<int32, TInlineAllocator<32>> MaxWidthForHeight;
+
+	//Room left on the stacks that aren't full, per item class
+	TMap<UClass*, int32> StackRoom;
+
+	bool CanFit(const FIntPoint Dimensions) const
+	{
+		return Dimensions.Y > 0 && Dimensions.Y <= MaxWidthForHeight.Num() && MaxWidthForHeight[Dimensions.Y - 1] >= Dimensions.X;
+	}
+
+	int32 GetStackRoom(UClass* ItemClass) const
+	{
+		const int32* Room = StackRoom.Find(ItemClass);
+		return Room ? *Room : 0;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FSIInventoryChunkArray> : public TStructOpsTypeTraitsBase2<FSIInventoryChunkArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class SI_API USIInventoryComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
 	friend class USIItem;
+	friend class USIContainerItem;
+	friend class USIInventoryViewerContents;
+	friend struct FSIInventoryChunkArray;
 
 public:
 	
@@ -28,7 +109,9 @@ public:
 protected:
 	
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
 	virtual bool ReplicateSubobjects(class UActorChannel *Channel, class FOutBunch *Bunch, FReplicationFlags *RepFlags) override;
 
 public:
@@ -50,6 +133,19 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	bool RemoveItem(class USIItem* Item);
 
+	//[server] Moves SplitQuantity of the stack into a new stack at TargetTile, or the first free spot when that doesn't fit.
+	//Returns the new stack, null if it couldn't be split or there is no room
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	USIItem* SplitStack(class USIItem* Item, const int32 SplitQuantity, const FInventoryTile TargetTile);
+
+	//[server] Moves as much of the source stack as fits onto the target stack, removing the source once empty. Returns how many were moved
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	int32 MergeStacks(class USIItem* SourceItem, class USIItem* TargetItem);
+
+	//[server] Pours the partial stacks of every class together, filling the ones nearest the top left first. Returns how many stacks were emptied
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	int32 ConsolidateStacks();
+
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	bool HasItem(TSubclassOf <class USIItem> ItemClass, const int32 Quantity = 1) const;
 
@@ -71,18 +167,58 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	FORCEINLINE int32 GetCapacity() const { return Rows * Columns; }
 
+	//Total weight of the contents, including the contents of container items. Cached until something changes
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	float GetCurrentWeight() const;
 
+	//Invalidates the cached weight and bumps the contents version of this inventory and of every inventory holding it through a container
+	void MarkContentsDirty();
+
+	//Bumped on any change to the contents, including quantities, rotations and the contents of containers in here
+	FORCEINLINE int32 GetContentsVersion() const { return ContentsVersion; }
+
+	//Weight that can still be added, for the inner grid of a container also limited by what the inventory holding it has left
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	float GetRemainingWeight() const;
+
+	//Free space and stack room of the inventory. Rebuilt in one pass over the grid when asked for after a change
+	const FSIInventoryRoutingSummary& GetRoutingSummary() const;
+
+	//[server] Adds up to Quantity of the item onto the stacks of its class that aren't full, no placement search involved.
+	//Returns how many were added, the item itself is left untouched
+	int32 TopUpStacks(class USIItem* Item, const int32 Quantity);
+
+	//The dense cell array, empty when bChunkedStorage is set. GetItemsMap works with both
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	FORCEINLINE TArray<class USIItem*> GetItems() const { return Items; }
 
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	TMap<class USIItem*, FInventoryTile> GetItemsMap() const;
 
+	//Returns the tile the item is anchored at, false if it isn't in this inventory
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	bool GetItemTile(class USIItem* Item, FInventoryTile& OutTile) const;
+
+	//Returns the item covering the tile, null if it is empty or out of the grid
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	USIItem* GetItemAtTile(FInventoryTile Tile) const;
+
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	bool IsRoomAvailable(class USIItem* Item, int32 TopLeftIndex, const bool bCurrentDimensions = true) const;
 
+	//Every anchor index the item fits at, in the same order as the grid. Built in one pass and cached until the inventory changes
+	const TBitArray<>& GetPlacementMask(class USIItem* Item, const bool bCurrentDimensions = true) const;
+
+	//Same answer as IsRoomAvailable, but a lookup in the placement mask
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	bool CanPlaceItemAt(class USIItem* Item, FInventoryTile Tile, const bool bCurrentDimensions = true) const;
+
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	TArray<FInventoryTile> GetValidPlacementTiles(class USIItem* Item, const bool bCurrentDimensions = true) const;
+
+	//Bumped on every change to the grid, anything derived from the layout can compare against it to know when to rebuild
+	FORCEINLINE int32 GetInventoryVersion() const { return InventoryVersion; }
+
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	FInventoryTile IndexToTile(int32 Index) const;
 	
@@ -95,6 +231,38 @@ public:
 	UFUNCTION(Client, Reliable)
 	void ClientRefreshInventory();
 
+	//Sets up the grid of a component created at runtime, call before registering it
+	void InitializeGrid(const int32 InRows, const int32 InColumns, const float InWeightCapacity, const bool bInChunkedStorage = false);
+
+	//[server] Recreates every item of the other inventory at the same tile in this one, which must be empty
+	void CopyContentsFrom(USIInventoryComponent* Other);
+
+	//False for items that can't go in here, like a container into its own grid
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	bool CanHoldItem(class USIItem* Item) const;
+
+	//[server] Lets the player's connection receive the contents when bReplicateToViewersOnly is set. Viewers are dropped again
+	//once they disconnect or can no longer reach the container this is the grid of
+	void AddViewer(class APlayerController* Viewer);
+	void RemoveViewer(class APlayerController* Viewer);
+
+	bool IsViewer(const class UNetConnection* Connection) const;
+
+	//The contents as plain data, for saving. Cheap enough to take on the game thread, serialize it on another
+	struct FSIInventorySnapshot CreateSnapshot() const;
+
+	//[server] Replaces the contents with the snapshot in one batch. Items already in here are reused where the type matches.
+	//False if something in it couldn't be restored, like an item type that no longer exists
+	bool RestoreSnapshot(const struct FSIInventorySnapshot& Snapshot);
+
+	//[server] While playing, saves under the old key one last time and loads what is saved under the new one
+	UFUNCTION(BlueprintSetter)
+	void SetPersistenceKey(const FString& NewKey);
+
+	//Streams in the thumbnails of everything in this inventory, called when the inventory UI opens
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void PreloadThumbnails();
+
 	// Events
 
 	UPROPERTY(BlueprintAssignable, Category = "Inventory")
@@ -106,16 +274,65 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Inventory")
 	FOnItemRemoved OnItemRemoved;
 
+	FOnInventoryItemChanged OnInventoryItemAdded;
+	FOnInventoryItemChanged OnInventoryItemRemoved;
+	FOnInventoryItemMoved OnInventoryItemMoved;
+	FOnInventoryItemChanged OnInventoryItemQuantityChanged;
+	FOnInventoryItemChanged OnInventoryItemRotated;
+
+	//Called by items of this inventory when their replicated state changes
+	void NotifyItemQuantityChanged(class USIItem* Item);
+	void NotifyItemRotated(class USIItem* Item);
+
 	// Config
 
 public:
 	
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory", meta = (ClampMin = 1, ClampMax = 20))
+	//Above 20 rows or columns, use bChunkedStorage. Placement masks are still built over the whole grid, hence the MaxGridSize clamp
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = "Inventory", meta = (ClampMin = 1, ClampMax = 256, UIMax = 20))
 	int32 Rows = 0;
 	
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory", meta = (ClampMin = 1, ClampMax = 20))
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = "Inventory", meta = (ClampMin = 1, ClampMax = 256, UIMax = 20))
 	int32 Columns = 0;
 
+	//Stores the grid in chunks that are only allocated and replicated while something is in them, instead of one array
+	//of every tile. Memory and bandwidth then follow the contents rather than the grid area, meant for large stashes
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = "Inventory")
+	bool bChunkedStorage = false;
+
+	//Where this inventory comes in the owner's inventory list, lower first. Loot goes to the first one it fits in
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory")
+	int32 RoutingPriority = 0;
+
+	//Key the contents are saved under by the inventory persistence subsystem. Left empty, the inventory isn't saved
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetPersistenceKey, Category = "Inventory|Persistence")
+	FString PersistenceKey;
+
+	//Only replicate the contents to the connections added with AddViewer. Set on the inner grid of container items
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory")
+	bool bReplicateToViewersOnly = false;
+
+	//Seconds between checks that the viewers are still connected and within reach
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory", meta = (ClampMin = 0.1, EditCondition = "bReplicateToViewersOnly"))
+	float ViewerCheckInterval = 1.f;
+
+	//The container item this is the inner grid of, if any
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Inventory")
+	class USIContainerItem* OwnerContainer;
+
+	//Journal recording the changes of this inventory, set while it is registered with it
+	UPROPERTY(Transient)
+	class USIInventoryJournalSubsystem* Journal = nullptr;
+
+	//Id of the PersistenceKey in the journal
+	int32 JournalKeyId = INDEX_NONE;
+
+	//Width and height in tiles of a storage chunk
+	static constexpr int32 ChunkSize = 8;
+
+	//Largest number of rows or columns, where rebuilding a placement mask after a change still costs well under a millisecond
+	static constexpr int32 MaxGridSize = 256;
+
 protected:
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Replicated, Category = "Inventory")
@@ -124,6 +341,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, ReplicatedUsing = OnRep_Items, Category = "Inventory")
 	TArray<class USIItem*> Items;
 
+	//Occupied chunks when bChunkedStorage is set, replicated per chunk
+	UPROPERTY(Replicated)
+	FSIInventoryChunkArray ItemChunks;
+
 private:
 
 	UFUNCTION()
@@ -132,11 +353,118 @@ private:
 	UPROPERTY()
 	int32 ReplicatedItemsKey;
 
+	//Anchor index of every item as of the last OnRep_Items, diffed against to find what changed
+	UPROPERTY(Transient)
+	TMap<class USIItem*, int32> ItemAnchors;
+
+	TSharedPtr<FStreamableHandle> ThumbnailsHandle;
+
+	int32 InventoryVersion = 0;
+
+	int32 ContentsVersion = 0;
+
+	UPROPERTY(Transient)
+	TArray<class APlayerController*> Viewers;
+
+	//The cells as sent to the viewers, only exists once there has been one
+	UPROPERTY(Transient)
+	class USIInventoryViewerContents* ViewerContents;
+
+	FTimerHandle ViewerCheckHandle;
+
+	void CheckViewers();
+
+	//[client] Takes over the cells received through ViewerContents
+	void ApplyViewerContents(const TArray<class USIItem*>& Cells);
+
+	mutable float CachedWeight = 0.f;
+	mutable bool bWeightDirty = true;
+
+	mutable FSIInventoryRoutingSummary RoutingSummary;
+	mutable bool bRoutingSummaryDirty = true;
+
+	void BuildRoutingSummary() const;
+
+	//Anchor index of an item, also for items placed during a batch that aren't in ItemAnchors yet
+	int32 FindAnchorIndex(const class USIItem* Item) const;
+
+	struct FPlacementMask
+	{
+		FIntPoint Dimensions;
+
+		//The item whose own cells count as free, only compared against
+		const class USIItem* IgnoredItem = nullptr;
+
+		int32 Version = INDEX_NONE;
+
+		TBitArray<> Mask;
+	};
+
+	//Masks for the last few footprints asked for, usually the dragged item in both orientations
+	mutable TArray<FPlacementMask, TInlineAllocator<4>> PlacementMasks;
+
+	mutable int32 NextPlacementMask = 0;
+
+	void BuildPlacementMask(FPlacementMask& PlacementMask) const;
+
+	//Placement mask for any footprint, IgnoredItem may be null to treat every occupied tile as taken
+	const TBitArray<>& GetFootprintMask(const FIntPoint Dimensions, const class USIItem* IgnoredItem) const;
+
+	//Changes to the grid made between these rebuild the anchors, notify and replicate once, when the outermost batch ends
+	void BeginBatch();
+	void EndBatch();
+
+	//OnRep_Items right away, or at the end of the batch
+	void NotifyItemsChanged();
+
+	//ClientRefreshInventory right away, or at the end of the batch
+	void RequestClientRefresh();
+
+	int32 BatchDepth = 0;
+	bool bBatchItemsChanged = false;
+	bool bBatchRefreshPending = false;
+
+	//Containers taken out of the grid, their inner grid goes with them unless they were moved or dropped with it
+	UPROPERTY(Transient)
+	TArray<class USIContainerItem*> RemovedContainers;
+
+	//Right after the removal, or at the end of the batch so a move within the batch can take the grid along first
+	void ReleaseRemovedContainers();
+
+	//[server] Loads the contents saved under the PersistenceKey, then starts saving and journaling them
+	void RegisterPersistence();
+	void UnregisterPersistence();
+
+	bool CanPlaceItemAtIndex(class USIItem* Item, const int32 TopLeftIndex, const bool bCurrentDimensions) const;
+
+	//Adds the freshly loaded thumbnails to the thumbnail atlas
+	void OnThumbnailsLoaded();
+
+	//Index into ItemChunks of every chunk by its coordinate
+	TMap<FIntPoint, int32> ChunkLookup;
+
 	// Internal
 
+	//Storage access, every read and write of a tile goes through these so both storage modes behave the same
+	USIItem* GetItemAtIndex(const int32 Index) const;
+	void SetItemAtIndex(const int32 Index, class USIItem* Item);
+
+	FORCEINLINE bool IsIndexValid(const int32 Index) const { return GetGridShape().IsIndexValid(Index); }
+
+	FORCEINLINE SIInventory::FGridShape GetGridShape() const { return SIInventory::FGridShape(Rows, Columns); }
+
+	//Sets the bit of every tile covered by an item other than IgnoredItem
+	void BuildOccupancy(TBitArray<>& OutOccupied, const class USIItem* IgnoredItem) const;
+
+	//Calls Func for every occupied tile. Dense storage visits them in index order, chunked storage chunk by chunk
+	void ForEachOccupiedTile(TFunctionRef<void(int32 Index, class USIItem* Item)> Func) const;
+
+	void RebuildChunkLookup();
+
 	FSIItemAddResult TryAddItem_Internal(class USIItem* Item, const int32 TopLeftIndex);
 
-	USIItem* AddItem(class USIItem* Item, const int32 TopLeftIndex, const int32 Quantity);
+	//Places a copy of Item lying as bPlaceRotated says, trial placements pass the rotation instead of rotating the item
+	USIItem* AddItem(class USIItem* Item, const int32 TopLeftIndex, const int32 Quantity, const bool bPlaceRotated);
 	
 	void TryMoveItem_Internal(class USIItem* Item, const FInventoryTile TargetTile);
 		
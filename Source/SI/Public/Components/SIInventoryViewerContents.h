@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "SIInventoryViewerContents.generated.h"
+
+/**
+ * The layout of an inventory that only replicates to the players looking into it, like the inner grid of a container.
+ * Property conditions are the same for every connection, so instead of the component's own cells this copy of them is
+ * replicated as a subobject, on the channels of the viewers alone.
+ */
+UCLASS()
+class SI_API USIInventoryViewerContents : public UObject
+{
+	GENERATED_BODY()
+
+protected:
+
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty> & OutLifetimeProps) const override;
+	virtual bool IsSupportedForNetworking() const override;
+
+public:
+
+	//[server] Copies the cells of the inventory this is the outer of
+	void CopyFrom(const class USIInventoryComponent* Inventory);
+
+	//Every tile of the grid, row by row
+	UPROPERTY(ReplicatedUsing = OnRep_Cells)
+	TArray<class USIItem*> Cells;
+
+	UFUNCTION()
+	void OnRep_Cells();
+	
+};
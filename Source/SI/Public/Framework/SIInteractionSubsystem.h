@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SIInteractionSubsystem.generated.h"
+
+USTRUCT()
+struct FSIActiveInteraction
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	class ASICharacter* Character = nullptr;
+
+	UPROPERTY()
+	class USIInteractionComponent* Interactable = nullptr;
+
+	UPROPERTY()
+	float Elapsed = 0.f;
+
+	UPROPERTY()
+	float Duration = 0.f;
+};
+
+/**
+ * Keeps track of every interactable in the world, so a trace hit can be resolved to its interaction component
+ * without iterating the hit actor's components.
+ * Interactables are also bucketed in a coarse spatial hash, used as a cheap proximity source for interaction candidates.
+ * Hold to interact progress of every character is advanced here in a single flat loop and pushed to the interactables.
+ */
+UCLASS(Config = Game)
+class SI_API USIInteractionSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return ActiveInteractions.Num() > 0; }
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	// API
+
+	void RegisterInteractable(class USIInteractionComponent* Interactable);
+	void UnregisterInteractable(class USIInteractionComponent* Interactable);
+
+	//Moves an interactable to the bucket of its owner's current location, call this after moving an interactable actor
+	void UpdateInteractable(class USIInteractionComponent* Interactable);
+
+	//Adds the interactables whose bucket overlaps the sphere. Results are not sorted and may be slightly outside the radius
+	void GatherInteractables(const FVector& Location, const float Radius, TArray<class USIInteractionComponent*, TInlineAllocator<32>>& OutInteractables) const;
+
+	//Returns the interaction component of an actor, or nullptr if it has none
+	FORCEINLINE class USIInteractionComponent* FindInteractable(const AActor* Actor) const
+	{
+		USIInteractionComponent* const* Found = Interactables.Find(Actor);
+		return Found ? *Found : nullptr;
+	}
+
+	// Interaction Progress
+
+	//Starts a hold to interact. The character's Interact is called once the interactable's InteractionTime has passed
+	void BeginInteraction(class ASICharacter* Character, class USIInteractionComponent* Interactable);
+
+	//Stops the character's hold to interact, if it has one
+	void EndInteraction(class ASICharacter* Character);
+
+	bool IsInteracting(const class ASICharacter* Character) const;
+
+	float GetRemainingInteractTime(const class ASICharacter* Character) const;
+
+protected:
+
+	int32 FindActiveInteraction(const class ASICharacter* Character) const;
+
+	UPROPERTY()
+	TArray<FSIActiveInteraction> ActiveInteractions;
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	void AddToCell(class USIInteractionComponent* Interactable, const FIntVector& Cell);
+	void RemoveFromCell(class USIInteractionComponent* Interactable);
+
+	//Size of a spatial hash bucket, roughly the interaction distance works well
+	UPROPERTY(Config)
+	float CellSize = 500.f;
+
+	//Not UPROPERTYs, components remove themselves when they unregister
+	TMap<const AActor*, class USIInteractionComponent*> Interactables;
+
+	TMap<FIntVector, TArray<class USIInteractionComponent*>> Cells;
+	TMap<const class USIInteractionComponent*, FIntVector> InteractableCells;
+
+};
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Persistence/SIInventoryJournal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "SIInventoryJournalSubsystem.generated.h"
+
+/**
+ * Crash recovery for the inventories saved by the persistence subsystem.
+ * Every change to a registered inventory is recorded as a small entry in a buffer, which is handed to the journal thread
+ * once per frame, so a change costs an array append on the game thread. Every CheckpointInterval the full contents are
+ * written as a checkpoint, captured a few inventories per frame, which starts a new journal file and drops the older ones.
+ * The journal left behind is replayed onto its checkpoint when the server first uses the journal, and the result is what
+ * LoadInventory restores when it is newer than the saved inventory. Clients never read it.
+ */
+UCLASS(Config = Game)
+class SI_API USIInventoryJournalSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+
+	// API
+
+	//[server] Starts journaling the changes of the inventory under its PersistenceKey, once its saved contents were loaded.
+	//Contents recovered for the key that the load didn't take are restored first
+	void RegisterInventory(class USIInventoryComponent* Inventory);
+
+	//[server] Stops journaling the inventory, it is left out of the following checkpoints
+	void UnregisterInventory(class USIInventoryComponent* Inventory);
+
+	//[server] The contents the journal recovered for the key, if any. Each is handed out once
+	bool TakeRecoveredSnapshot(const FString& Key, FSIInventorySnapshot& OutSnapshot);
+
+	//Called by journaled inventories as they change
+	FORCEINLINE void RecordAdd(const int32 KeyId, UClass* ItemClass, const int32 Anchor, const int32 Quantity, const bool bRotated)
+	{
+		RecordEntry(ESIInventoryJournalOp::Add, KeyId, Anchor, Quantity, bRotated).TypeId = GetTypeId(ItemClass);
+	}
+
+	FORCEINLINE void RecordRemove(const int32 KeyId, const int32 Anchor)
+	{
+		RecordEntry(ESIInventoryJournalOp::Remove, KeyId, Anchor, 0, false);
+	}
+
+	FORCEINLINE void RecordQuantity(const int32 KeyId, const int32 Anchor, const int32 Quantity)
+	{
+		RecordEntry(ESIInventoryJournalOp::Quantity, KeyId, Anchor, Quantity, false);
+	}
+
+	FORCEINLINE void RecordRotate(const int32 KeyId, const int32 Anchor, const bool bRotated)
+	{
+		RecordEntry(ESIInventoryJournalOp::Rotate, KeyId, Anchor, 0, bRotated);
+	}
+
+	//Records the whole contents, for changes that replace everything like restoring a snapshot
+	void RecordSnapshot(class USIInventoryComponent* Inventory);
+
+	//Records the whole contents with the next batch, once however often it is asked. For the changes inside the
+	//containers of the inventory, which the entries can't express
+	void RequestSnapshot(class USIInventoryComponent* Inventory);
+
+	//Writes a checkpoint on the next frame instead of waiting for the interval
+	UFUNCTION(BlueprintCallable, Category = "Inventory Journal")
+	void RequestCheckpoint() { bCheckpointRequested = true; }
+
+	// Config
+
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Inventory Journal")
+	bool bEnableJournal = true;
+
+	//Seconds between checkpoints. Longer intervals write less but leave more to replay after a crash
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Inventory Journal", meta = (ClampMin = 1.0))
+	float CheckpointInterval = 60.f;
+
+	//Most inventories captured per frame for a checkpoint, one with more carries on over the next frames
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Inventory Journal", meta = (ClampMin = 1))
+	int32 MaxCheckpointCapturesPerFrame = 64;
+
+	//Folder of the journal files, relative to the project's Saved folder
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Inventory Journal")
+	FString JournalDirectory = TEXT("Persistence/Journal");
+
+protected:
+
+	FString GetJournalPath() const;
+
+	//Recovers the journal left behind and creates the writer and its thread on first use, so clients never do either
+	bool EnsureWriter();
+
+	FORCEINLINE FSIInventoryJournalEntry& RecordEntry(const ESIInventoryJournalOp Op, const int32 KeyId, const int32 Anchor, const int32 Quantity, const bool bRotated)
+	{
+		FSIInventoryJournalEntry& Entry = PendingBatch.Entries.AddDefaulted_GetRef();
+		Entry.Op = Op;
+		Entry.KeyId = KeyId;
+		Entry.Anchor = Anchor;
+		Entry.Quantity = Quantity;
+		Entry.bRotated = bRotated;
+
+		return Entry;
+	}
+
+	FORCEINLINE int32 GetTypeId(UClass* ItemClass)
+	{
+		if (const int32* TypeId = TypeIds.Find(ItemClass))
+		{
+			return *TypeId;
+		}
+
+		return AddTypeId(ItemClass);
+	}
+
+	int32 AddTypeId(UClass* ItemClass);
+
+	int32 GetKeyId(const FString& Key);
+
+	//Starts a checkpoint with the next batch, of the inventories journaled by now
+	void BeginCheckpoint();
+
+	//Captures up to MaxCaptures inventories of the checkpoint into the pending batch. True once the checkpoint is complete
+	bool CaptureCheckpoint(const int32 MaxCaptures);
+
+	//Hands the pending batch to the journal thread
+	void SubmitPendingBatch();
+
+	struct FJournaledInventory
+	{
+		TWeakObjectPtr<class USIInventoryComponent> Inventory;
+
+		FString Key;
+
+		int32 KeyId = INDEX_NONE;
+	};
+
+	TArray<FJournaledInventory> JournaledInventories;
+
+	//Ids handed out to keys and item types so far, the journal refers to them by id
+	TMap<FString, int32> KeyIds;
+
+	UPROPERTY(Transient)
+	TMap<UClass*, int32> TypeIds;
+
+	//Recorded since the last frame
+	FSIInventoryJournalBatch PendingBatch;
+
+	//Inventories to record whole with the next batch
+	TArray<TWeakObjectPtr<class USIInventoryComponent>> PendingSnapshots;
+
+	//Inventories the checkpoint in progress hasn't captured yet. Those registered since record their own snapshot
+	TArray<FJournaledInventory> CheckpointQueue;
+
+	bool bCheckpointInProgress = false;
+
+	//Replayed from the journal on first use for keys not registered yet, kept in the checkpoints until then
+	TMap<FString, FSIInventorySnapshot> RecoveredSnapshots;
+
+	TUniquePtr<FSIInventoryJournalWriter> Writer;
+
+	bool bWriterFailed = false;
+
+	//The first batch has to carry a checkpoint, the entries after it mean nothing without one
+	bool bCheckpointRequested = true;
+
+	float TimeSinceCheckpoint = 0.f;
+
+};
@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Persistence/SIInventoryPersistenceWriter.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "SIInventoryPersistenceSubsystem.generated.h"
+
+/**
+ * Write-behind saving of inventories on the server.
+ * Inventories with a PersistenceKey register themselves when they begin play, which loads what was saved under the key
+ * before anything is captured. Every FlushInterval the inventories whose contents changed are captured as snapshots and
+ * handed to a background writer. The writer drops the ones that are
+ * byte for byte what it last wrote and stores the rest as one batch. Inventories leaving play and the subsystem shutting
+ * down flush right away, and shutdown waits for the writer to finish.
+ */
+UCLASS(Config = Game)
+class SI_API USIInventoryPersistenceSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+
+	// API
+
+	//[server] Loads the inventory saved under its PersistenceKey, then saves it whenever its contents change.
+	//OnLoaded is called once the load is done, also when there was nothing to load
+	void RegisterInventory(class USIInventoryComponent* Inventory, TFunction<void(bool)> OnLoaded = nullptr);
+
+	//[server] Saves the inventory one last time and stops tracking it
+	void UnregisterInventory(class USIInventoryComponent* Inventory);
+
+	//[server] Reads the inventory saved under its PersistenceKey in the background and restores it on the game thread.
+	//Contents the journal recovered after a crash are restored instead, they are newer than the saved ones.
+	//OnLoaded gets false when nothing was saved, or the inventory is gone or under another key by then
+	void LoadInventory(class USIInventoryComponent* Inventory, TFunction<void(bool)> OnLoaded = nullptr);
+
+	//[server] Replaces the contents of the inventory with what is saved under its PersistenceKey, once it was read
+	UFUNCTION(BlueprintCallable, Category = "Inventory Persistence", meta = (DisplayName = "Load Inventory"))
+	void K2_LoadInventory(class USIInventoryComponent* Inventory) { LoadInventory(Inventory); }
+
+	//Captures every changed inventory and wakes the writer, without waiting for the interval
+	UFUNCTION(BlueprintCallable, Category = "Inventory Persistence")
+	void FlushNow();
+
+	// Config
+
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Inventory Persistence")
+	bool bEnablePersistence = true;
+
+	//Seconds between captures of the changed inventories
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Inventory Persistence", meta = (ClampMin = 0.1))
+	float FlushInterval = 10.f;
+
+	//Most inventories captured per frame, a flush with more carries on over the next frames
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Inventory Persistence", meta = (ClampMin = 1))
+	int32 MaxCapturesPerFrame = 64;
+
+	//Database file of the default SQLite backend, relative to the project's Saved folder
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Inventory Persistence")
+	FString DatabaseFile = TEXT("Persistence/Inventories.db");
+
+protected:
+
+	//Backend the writer stores into. Override for another storage than the local SQLite file
+	virtual TUniquePtr<ISIInventoryPersistenceBackend> CreateBackend() const;
+
+	//Creates the writer and its thread on first use, so clients never start one
+	bool EnsureWriter();
+
+	//Captures the changed inventories from the cursor on, up to Budget of them. Returns true once it reached the end
+	bool CaptureChangedInventories(int32 Budget);
+
+	struct FTrackedInventory
+	{
+		TWeakObjectPtr<class USIInventoryComponent> Inventory;
+
+		FString Key;
+
+		//Contents version at the last capture
+		int32 CapturedVersion = INDEX_NONE;
+
+		//Loads not finished yet. The inventory isn't captured meanwhile, it would overwrite what is being loaded
+		int32 PendingLoads = 0;
+	};
+
+	FTrackedInventory* FindTrackedInventory(const class USIInventoryComponent* Inventory, const FString& Key);
+
+	TArray<FTrackedInventory> TrackedInventories;
+
+	//Where the capture pass resumes when it ran out of budget last frame
+	int32 CaptureCursor = 0;
+
+	bool bCaptureInProgress = false;
+
+	float TimeSinceFlush = 0.f;
+
+	TUniquePtr<FSIInventoryPersistenceWriter> Writer;
+
+	bool bWriterFailed = false;
+
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Styling/SlateBrush.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "SIThumbnailAtlasSubsystem.generated.h"
+
+/**
+ * Packs item thumbnails into a single render target, so the inventory grid draws every item from the same texture
+ * and Slate can batch them together. Each thumbnail material is drawn into the atlas once, the first time it is
+ * seen loaded, and then referenced through a brush pointing at its region of the atlas.
+ */
+UCLASS(Config = Game)
+class SI_API USIThumbnailAtlasSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	// API
+
+	//Draws the thumbnails of the given items into the atlas. Thumbnails that aren't loaded yet are skipped
+	void AddThumbnails(const TArray<class USIItem*>& Items);
+
+	//Brush of the thumbnail region in the atlas, null if it hasn't been added
+	FORCEINLINE const FSlateBrush* FindThumbnailBrush(const class UMaterialInterface* Thumbnail) const { return ThumbnailBrushes.Find(Thumbnail); }
+
+	UFUNCTION(BlueprintPure, Category = "Thumbnail Atlas")
+	FORCEINLINE class UTextureRenderTarget2D* GetAtlasTexture() const { return Atlas; }
+
+	// Config
+
+	//Width and height of the atlas in pixels
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Thumbnail Atlas", meta = (ClampMin = 256, ClampMax = 8192))
+	int32 AtlasSize = 2048;
+
+	//Pixels per inventory tile. A 2x3 item takes 2 * TileResolution by 3 * TileResolution pixels in the atlas
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Thumbnail Atlas", meta = (ClampMin = 8, ClampMax = 512))
+	int32 TileResolution = 64;
+
+protected:
+
+	//Finds room for a region of the given size, packing regions in rows. False once the atlas is full
+	bool AllocateRegion(const FIntPoint& Size, FIntPoint& OutPosition);
+
+	bool EnsureAtlas();
+
+	UPROPERTY(Transient)
+	class UTextureRenderTarget2D* Atlas;
+
+	UPROPERTY(Transient)
+	TMap<class UMaterialInterface*, FSlateBrush> ThumbnailBrushes;
+
+	//Top left of the next region in the current row
+	FIntPoint RowCursor = FIntPoint::ZeroValue;
+
+	//Height of the tallest region in the current row
+	int32 RowHeight = 0;
+
+};
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/SIItem.h"
+#include "Library/SIInventoryStructLibrary.h"
+#include "SIContainerItem.generated.h"
+
+/**
+ * An item with its own inventory grid, like a backpack, rig or case.
+ * The inner grid is an inventory component on the actor holding the item, only created the first time the container
+ * is opened or filled. Its contents only replicate to the players who opened it.
+ */
+UCLASS(Abstract, Blueprintable, EditInlineNew, DefaultToInstanced)
+class SI_API USIContainerItem : public USIItem
+{
+	GENERATED_BODY()
+
+public:
+
+	USIContainerItem();
+
+protected:
+
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty> & OutLifetimeProps) const override;
+	virtual void PostRename(UObject* OldOuter, const FName OldName) override;
+
+public:
+
+	virtual float GetStackWeight() const override;
+	virtual void CopyStateFrom(USIItem* Source) override;
+
+	// API
+
+	UFUNCTION(BlueprintPure, Category = "Container")
+	FORCEINLINE class USIInventoryComponent* GetInnerInventory() const { return InnerInventory; }
+
+	//[server] Returns the inner grid, creating it on the actor holding the container the first time
+	class USIInventoryComponent* GetOrCreateInnerInventory();
+
+	//[server] Starts replicating the contents to the player
+	void OpenFor(class APlayerController* Viewer);
+
+	//[server] Stops replicating changes to the player
+	void CloseFor(class APlayerController* Viewer);
+
+	//[server]
+	UFUNCTION(BlueprintCallable, Category = "Container")
+	FSIItemAddResult TryAddItemToContainer(class USIItem* Item);
+
+	//[server] Destroys the inner grid and everything in it, including the grids of containers inside. For containers that are gone for good
+	void DestroyInnerInventory();
+
+	// Config
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Container", meta = (ClampMin = 1, ClampMax = 20))
+	int32 InnerRows = 4;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Container", meta = (ClampMin = 1, ClampMax = 20))
+	int32 InnerColumns = 4;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Container", meta = (ClampMin = 0.0))
+	float InnerWeightCapacity = 50.f;
+
+	//Whether other containers can be put inside this one
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Container")
+	bool bAllowNestedContainers = false;
+
+protected:
+
+	//Takes over the inner grid of another container item, moving the contents over if it lives on another actor
+	void AdoptInnerInventory(class USIInventoryComponent* SourceInventory);
+
+	class USIInventoryComponent* CreateInnerInventory(AActor* InventoryOwner);
+
+	UFUNCTION()
+	void OnRep_InnerInventory();
+
+	UPROPERTY(ReplicatedUsing = OnRep_InnerInventory)
+	class USIInventoryComponent* InnerInventory;
+	
+};
@@ -3,6 +3,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Items/SIItemDefinition.h"
 #include "Library/SIInventoryEnumLibrary.h"
 #include "UObject/NoExportTypes.h"
 #include "SIItem.generated.h"
@@ -34,52 +36,129 @@ protected:
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
-public:
+	virtual void PostLoad() override;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	class UStaticMesh* PickupMesh;
+	//Moves the definition data saved on item classes from before definitions existed into a definition in the same package.
+	//Runs on every load until the blueprint is resaved, so cooked and standalone builds read the old data instead of the defaults
+	void MigrateDeprecatedDefinition();
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
-	class UMaterialInterface* Thumbnail;
+	// Kept outside editor only data, they are the fallback for item blueprints that haven't been resaved since definitions
+	UPROPERTY(meta = (DeprecatedProperty))
+	TSoftObjectPtr<class UStaticMesh> PickupMesh_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	TSoftObjectPtr<class UMaterialInterface> Thumbnail_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	TSoftObjectPtr<class UMaterialInterface> ThumbnailRotated_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	FText DisplayName_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	FText Description_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	FText UseActionText_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	ESIItemRarity Rarity_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	float Weight_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	bool bStackable_DEPRECATED;
 
+	UPROPERTY(meta = (DeprecatedProperty))
+	int32 MaxStackSize_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	TSubclassOf<class USIItemTooltipWidget> ItemTooltip_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	FIntPoint Dimensions_DEPRECATED;
+
+public:
+
+	//Shared by every instance of the item, see USIItemDefinition. Instances only carry their own quantity and rotation
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
-	class UMaterialInterface* ThumbnailRotated;
+	USIItemDefinition* Definition;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	FText DisplayName;
+	//Never null, items without a definition read the defaults
+	FORCEINLINE const USIItemDefinition* GetDefinition() const { return Definition ? Definition : GetDefault<USIItemDefinition>(); }
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (MultiLine = true))
-	FText Description;
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE FText GetDisplayName() const { return GetDefinition()->DisplayName; }
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	FText UseActionText;
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE FText GetDescription() const { return GetDefinition()->Description; }
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	ESIItemRarity Rarity;
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE FText GetUseActionText() const { return GetDefinition()->UseActionText; }
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (ClampMin = 0.0))
-	float Weight;
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE ESIItemRarity GetRarity() const { return GetDefinition()->Rarity; }
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	bool bStackable;
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE float GetWeight() const { return GetDefinition()->Weight; }
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (ClampMin = 2, EditCondition = bStackable))
-	int32 MaxStackSize;
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE bool IsStackable() const { return GetDefinition()->bStackable; }
+
+	//1 for items that don't stack
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE int32 GetMaxStackSize() const { return GetDefinition()->GetMaxQuantity(); }
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	TSubclassOf<class USIItemTooltipWidget> ItemTooltip;
+	FORCEINLINE TSubclassOf<class USIItemTooltipWidget> GetItemTooltipClass() const { return GetDefinition()->ItemTooltip; }
+
+	FORCEINLINE const TSoftObjectPtr<class UStaticMesh>& GetPickupMesh() const { return GetDefinition()->PickupMesh; }
+	FORCEINLINE const TSoftObjectPtr<class UMaterialInterface>& GetThumbnailAsset() const { return GetDefinition()->Thumbnail; }
+	FORCEINLINE const TSoftObjectPtr<class UMaterialInterface>& GetThumbnailRotatedAsset() const { return GetDefinition()->ThumbnailRotated; }
 
 	UFUNCTION(BlueprintPure, Category = "Item")
 	virtual float GetStackWeight() const;
 
+	//Weight of one of the item counting anything inside it, what weight limits are checked against
+	UFUNCTION(BlueprintPure, Category = "Item")
+	float GetUnitWeight() const;
+
 	UFUNCTION(BlueprintPure, Category = "Item")
-	FORCEINLINE bool IsStackFull() const { return Quantity >= MaxStackSize; }
+	FORCEINLINE bool IsStackFull() const { return Quantity >= GetMaxStackSize(); }
 
 	UFUNCTION(BlueprintPure, Category = "Item")
-	FORCEINLINE UMaterialInterface* GetThumbnail(const bool bCurrentRotated = true) const { return bCurrentRotated ? bRotated ? ThumbnailRotated : Thumbnail : bNewRotated ? ThumbnailRotated : Thumbnail; }
+	UMaterialInterface* GetThumbnail(const bool bCurrentRotated = true) const;
 
 	UFUNCTION(BlueprintPure, Category = "Item")
-	FORCEINLINE FIntPoint GetDimensions(const bool bCurrent = true) const { return bCurrent ? bRotated ? FIntPoint(Dimensions.Y, Dimensions.X) : Dimensions : bNewRotated ? FIntPoint(Dimensions.Y, Dimensions.X) : Dimensions; }
+	FORCEINLINE FIntPoint GetDimensions(const bool bCurrent = true) const
+	{
+		const FIntPoint& Dimensions = GetDefinition()->Dimensions;
+		return (bCurrent ? bRotated : bNewRotated) ? FIntPoint(Dimensions.Y, Dimensions.X) : Dimensions;
+	}
+
+	//Dimensions ignoring rotation
+	FORCEINLINE FIntPoint GetBaseDimensions() const { return GetDefinition()->Dimensions; }
+
+	// Blueprint compatibility. Widgets made before definitions read these as properties of the item, the nodes below carry
+	// the same names and forward to the definition so their graphs only need the variable nodes swapped
+
+	UFUNCTION(BlueprintPure, Category = "Item|Definition", meta = (DisplayName = "Display Name"))
+	FORCEINLINE FText K2_DisplayName() const { return GetDisplayName(); }
+
+	UFUNCTION(BlueprintPure, Category = "Item|Definition", meta = (DisplayName = "Description"))
+	FORCEINLINE FText K2_Description() const { return GetDescription(); }
+
+	UFUNCTION(BlueprintPure, Category = "Item|Definition", meta = (DisplayName = "Rarity"))
+	FORCEINLINE ESIItemRarity K2_Rarity() const { return GetRarity(); }
+
+	UFUNCTION(BlueprintPure, Category = "Item|Definition", meta = (DisplayName = "Weight"))
+	FORCEINLINE float K2_Weight() const { return GetWeight(); }
+
+	UFUNCTION(BlueprintPure, Category = "Item|Definition", meta = (DisplayName = "Stackable"))
+	FORCEINLINE bool K2_Stackable() const { return IsStackable(); }
+
+	UFUNCTION(BlueprintPure, Category = "Item|Definition", meta = (DisplayName = "Item Tooltip"))
+	FORCEINLINE TSubclassOf<class USIItemTooltipWidget> K2_ItemTooltip() const { return GetItemTooltipClass(); }
 
 	UPROPERTY()
 	class USIInventoryComponent* OwningInventory;
@@ -94,12 +173,20 @@ public:
 
 	virtual void AddedToInventory(class USIInventoryComponent* Inventory);
 
-protected:
+	//Called on the copy an inventory makes of an item it is given, to carry over state that lives beyond quantity and rotation
+	virtual void CopyStateFrom(USIItem* Source);
 
-	UPROPERTY(EditDefaultsOnly, Category = "Item")
-	FIntPoint Dimensions;
+	// Streaming
+
+	//Streams in the pickup mesh. OnLoaded is called once it is loaded, right away if it already is
+	TSharedPtr<FStreamableHandle> RequestPickupMesh(FStreamableDelegate OnLoaded = FStreamableDelegate()) const;
+
+	//Streams in the thumbnails of all the given items in a single request
+	static TSharedPtr<FStreamableHandle> RequestThumbnails(const TArray<USIItem*>& Items, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+protected:
 
-	UPROPERTY(ReplicatedUsing = OnRep_Quantity, EditAnywhere, Category = "Item", meta = (UIMin = 1, EditCondition = bStackable))
+	UPROPERTY(ReplicatedUsing = OnRep_Quantity, EditAnywhere, Category = "Item", meta = (UIMin = 1))
 	int32 Quantity;
 
 	UPROPERTY(ReplicatedUsing = OnRep_Rotated, VisibleAnywhere, Category = "Item")
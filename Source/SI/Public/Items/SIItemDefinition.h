@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Library/SIInventoryEnumLibrary.h"
+#include "SIItemDefinition.generated.h"
+
+/**
+ * Everything about an item that is the same for every instance of it. Instances only keep a pointer to their definition,
+ * alongside their quantity and rotation.
+ * The fields the inventory reads on every add and placement come first, so they share a cache line.
+ */
+UCLASS(BlueprintType)
+class SI_API USIItemDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	USIItemDefinition();
+
+	// Placement
+
+	//Size in tiles, unrotated
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (ClampMin = 1))
+	FIntPoint Dimensions;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (ClampMin = 0.0))
+	float Weight;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (ClampMin = 2, EditCondition = bStackable))
+	int32 MaxStackSize;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	bool bStackable;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	ESIItemRarity Rarity;
+
+	// Presentation
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	FText DisplayName;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (MultiLine = true))
+	FText Description;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	FText UseActionText;
+
+	//Render assets are soft references so loading a definition doesn't pull them in, use the item's Request functions to stream them
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	TSoftObjectPtr<class UStaticMesh> PickupMesh;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	TSoftObjectPtr<class UMaterialInterface> Thumbnail;
+
+	//Optional. When unset the inventory grid draws Thumbnail rotated through the thumbnail atlas
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	TSoftObjectPtr<class UMaterialInterface> ThumbnailRotated;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	TSubclassOf<class USIItemTooltipWidget> ItemTooltip;
+
+	FORCEINLINE int32 GetMaxQuantity() const { return bStackable ? MaxStackSize : 1; }
+	
+};
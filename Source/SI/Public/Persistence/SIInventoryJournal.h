@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "Persistence/SIInventorySnapshot.h"
+
+enum class ESIInventoryJournalOp : uint8
+{
+	//Names a key or item type id, written before the first record using it
+	DefineKey,
+	DefineType,
+
+	//An item placed at an anchor
+	Add,
+
+	//The item at an anchor taken out
+	Remove,
+
+	//The item at an anchor now has this quantity, zero when it was emptied
+	Quantity,
+
+	//The item at an anchor now has this rotation
+	Rotate,
+
+	//Full contents of an inventory, part of a checkpoint
+	Snapshot,
+
+	//Every snapshot of the checkpoint was written, the file can be recovered from
+	CheckpointEnd
+};
+
+/**One inventory change, small and flat so recording it is a plain array append*/
+struct FSIInventoryJournalEntry
+{
+	ESIInventoryJournalOp Op = ESIInventoryJournalOp::Add;
+
+	bool bRotated = false;
+
+	int32 KeyId = 0;
+	int32 TypeId = 0;
+	int32 Anchor = 0;
+	int32 Quantity = 0;
+};
+
+/**Everything recorded on the game thread since the last hand off to the journal thread*/
+struct FSIInventoryJournalBatch
+{
+	TArray<TPair<int32, FString>> NewKeys;
+	TArray<TPair<int32, FString>> NewTypes;
+
+	TArray<FSIInventoryJournalEntry> Entries;
+
+	//Contents for the Snapshot entries, in the same order
+	TArray<TPair<int32, FSIInventorySnapshot>> Snapshots;
+
+	//A checkpoint is captured over several frames. The first batch starts it, each carries the inventories captured in its
+	//frame, after the entries above, and the last one ends it
+	bool bCheckpointStart = false;
+	bool bCheckpointEnd = false;
+	TArray<TPair<int32, FSIInventorySnapshot>> Checkpoint;
+};
+
+/**
+ * Append-only journal of inventory changes, written to numbered files in a folder by its own thread.
+ * Each file starts with a checkpoint, the full contents of every journaled inventory, followed by the changes made since.
+ * Starting a checkpoint opens the next file, and the older files are deleted once the new checkpoint is complete. Until
+ * then changes go to both files, the snapshots captured after them in the new one replace what they changed.
+ * Recovery reads the newest file with a complete checkpoint and replays its changes onto the snapshots as plain data.
+ */
+class SI_API FSIInventoryJournalWriter : public FRunnable
+{
+public:
+
+	explicit FSIInventoryJournalWriter(const FString& InDirectory);
+	virtual ~FSIInventoryJournalWriter();
+
+	bool Start();
+
+	//Writes what is still queued and waits for the thread to finish
+	void Shutdown();
+
+	//Game thread only
+	void EnqueueBatch(FSIInventoryJournalBatch&& Batch);
+
+	//Reads the newest recoverable journal in the folder and replays it. Returns the state of every inventory in it by key
+	static bool Recover(const FString& Directory, TMap<FString, FSIInventorySnapshot>& OutSnapshots);
+
+	// FRunnable
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	virtual void Exit() override;
+
+private:
+
+	void ProcessBatches();
+
+	void WriteEntry(FArchive& Ar, const FSIInventoryJournalEntry& Entry);
+	void WriteDefine(FArchive& Ar, const ESIInventoryJournalOp Op, int32 Id, FString Name);
+	void WriteSnapshot(FArchive& Ar, int32 KeyId, const FSIInventorySnapshot& Snapshot);
+
+	//Opens the next journal file and writes the keys and types into it, the checkpoint snapshots follow as they come
+	void BeginCheckpointFile();
+
+	//Marks the checkpoint complete and moves the changes over to the new file, then deletes the older files
+	void EndCheckpointFile();
+
+	static void ListJournalFiles(const FString& Directory, TArray<TPair<int32, FString>>& OutFiles);
+
+	FString Directory;
+
+	TQueue<FSIInventoryJournalBatch, EQueueMode::Spsc> PendingBatches;
+
+	//Every key and type defined so far, written again at the top of each new file
+	TMap<int32, FString> Keys;
+	TMap<int32, FString> Types;
+
+	FArchive* File = nullptr;
+
+	//The next file while its checkpoint is being written
+	FArchive* CheckpointFile = nullptr;
+
+	int32 FileNumber = 0;
+
+	//Reused for encoding each batch before it is appended in one write
+	TArray<uint8> Buffer;
+	TArray<uint8> SnapshotBuffer;
+
+	FEvent* WakeEvent = nullptr;
+
+	FRunnableThread* Thread = nullptr;
+
+	TAtomic<bool> bStopping;
+};
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**A serialized inventory snapshot and the key it is stored under*/
+struct FSIInventoryRecord
+{
+	FString Key;
+
+	TArray<uint8> Data;
+};
+
+/**
+ * Where the inventory persistence writer stores snapshots. Open is called by the thread starting the writer, before the
+ * writer thread exists, and every other call is made from the writer thread, one at a time. Backends don't need any
+ * locking of their own.
+ */
+class SI_API ISIInventoryPersistenceBackend
+{
+public:
+
+	virtual ~ISIInventoryPersistenceBackend() {}
+
+	virtual bool Open() = 0;
+	virtual void Close() = 0;
+
+	//Stores every record, replacing what was stored under the same keys. All or nothing where the backend supports it
+	virtual bool WriteBatch(const TArray<FSIInventoryRecord>& Records) = 0;
+
+	//False if nothing is stored under the key
+	virtual bool Read(const FString& Key, TArray<uint8>& OutData) = 0;
+};
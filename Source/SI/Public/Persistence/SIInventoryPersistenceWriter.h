@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "Persistence/SIInventoryPersistenceBackend.h"
+#include "Persistence/SIInventorySnapshot.h"
+
+/**
+ * Background thread between the game and a persistence backend. The game thread queues snapshots and reads. The
+ * thread serializes the snapshots, drops the ones that haven't changed since they were last written, and hands the
+ * rest to the backend as one batch.
+ * Reads are answered after every write queued before them, and their callbacks run on the game thread.
+ */
+class SI_API FSIInventoryPersistenceWriter : public FRunnable
+{
+public:
+
+	explicit FSIInventoryPersistenceWriter(TUniquePtr<ISIInventoryPersistenceBackend> InBackend);
+	virtual ~FSIInventoryPersistenceWriter();
+
+	//Opens the backend and starts the thread. False if the backend couldn't be opened, nothing is queued then
+	bool Start();
+
+	//Writes what is still queued, closes the backend and waits for the thread to finish
+	void Shutdown();
+
+	//Game thread only
+	void EnqueueWrite(const FString& Key, FSIInventorySnapshot&& Snapshot);
+
+	//Game thread only. OnRead is called on the game thread, without a value if nothing was stored or it couldn't be read
+	void EnqueueRead(const FString& Key, TFunction<void(TOptional<FSIInventorySnapshot>)> OnRead);
+
+	//Wakes the thread to write what is queued
+	void Flush();
+
+	// FRunnable
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	virtual void Exit() override;
+
+private:
+
+	struct FPendingWrite
+	{
+		FString Key;
+		FSIInventorySnapshot Snapshot;
+	};
+
+	struct FPendingRead
+	{
+		FString Key;
+		TFunction<void(TOptional<FSIInventorySnapshot>)> OnRead;
+	};
+
+	void ProcessQueues();
+
+	TUniquePtr<ISIInventoryPersistenceBackend> Backend;
+
+	TQueue<FPendingWrite, EQueueMode::Spsc> PendingWrites;
+	TQueue<FPendingRead, EQueueMode::Spsc> PendingReads;
+
+	//Crc of what was last written per key, only touched by the thread
+	TMap<FString, uint32> WrittenHashes;
+
+	//Records of a batch the backend failed to write, tried again with the next one
+	TMap<FString, FSIInventoryRecord> UnwrittenRecords;
+
+	FEvent* WakeEvent = nullptr;
+
+	FRunnableThread* Thread = nullptr;
+
+	TAtomic<bool> bStopping;
+};
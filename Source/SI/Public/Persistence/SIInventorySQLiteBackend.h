@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Persistence/SIInventoryPersistenceBackend.h"
+
+/**
+ * Stores inventories in a local SQLite file, one row per key. Meant for development, tests and listen servers, a
+ * dedicated backend would talk to the game's own storage service instead.
+ */
+class SI_API FSIInventorySQLiteBackend : public ISIInventoryPersistenceBackend
+{
+public:
+
+	explicit FSIInventorySQLiteBackend(const FString& InFilename);
+	virtual ~FSIInventorySQLiteBackend();
+
+	virtual bool Open() override;
+	virtual void Close() override;
+	virtual bool WriteBatch(const TArray<FSIInventoryRecord>& Records) override;
+	virtual bool Read(const FString& Key, TArray<uint8>& OutData) override;
+
+private:
+
+	FString Filename;
+
+	TUniquePtr<class FSQLiteDatabase> Database;
+
+	//Prepared once when the database is opened
+	TUniquePtr<class FSQLitePreparedStatement> WriteStatement;
+	TUniquePtr<class FSQLitePreparedStatement> ReadStatement;
+};
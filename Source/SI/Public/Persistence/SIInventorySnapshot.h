@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+/**Versions of the snapshot format. Add new ones above VersionPlusOne and handle the older ones when reading*/
+enum class ESIInventorySnapshotVersion : uint16
+{
+	Initial = 1,
+
+	VersionPlusOne,
+	Latest = VersionPlusOne - 1
+};
+
+/**One item of a snapshot*/
+struct FSIInventorySnapshotItem
+{
+	//Index into the item type table of the snapshot
+	int32 TypeId = 0;
+
+	int32 Quantity = 1;
+
+	//Index of the top left tile of the item in the grid
+	int32 Anchor = 0;
+
+	bool bRotated = false;
+
+	//Index into InnerInventories of the snapshot, for container items that have contents
+	int32 InnerInventory = INDEX_NONE;
+};
+
+/**
+ * The contents of an inventory as plain data, so it can be written and read away from the game thread.
+ * Item types are written once in a table and referred to by index, every other number is written packed, so an item usually
+ * takes four or five bytes.
+ */
+struct SI_API FSIInventorySnapshot
+{
+	int32 Rows = 0;
+	int32 Columns = 0;
+
+	//Path of every item class in the snapshot
+	TArray<FString> ItemTypes;
+
+	//In grid order of their anchors
+	TArray<FSIInventorySnapshotItem> Items;
+
+	//Contents of the container items, can have containers of their own
+	TArray<FSIInventorySnapshot> InnerInventories;
+
+	//Writes the snapshot with a header and version in front
+	void Serialize(TArray<uint8>& OutBytes) const;
+
+	//False if the data is not a snapshot, from a newer version or cut short
+	static bool Deserialize(const TArray<uint8>& Bytes, FSIInventorySnapshot& OutSnapshot);
+
+	//Serializes on a worker thread. The snapshot is moved in, so the game thread can keep changing the inventory meanwhile
+	static TFuture<TArray<uint8>> SerializeAsync(FSIInventorySnapshot&& Snapshot);
+
+	//Serializes and writes the file on a worker thread
+	static TFuture<bool> SaveToFileAsync(FSIInventorySnapshot&& Snapshot, const FString& Filename);
+
+	//Reads and deserializes the file on a worker thread, unset if it couldn't be read
+	static TFuture<TOptional<FSIInventorySnapshot>> LoadFromFileAsync(const FString& Filename);
+
+private:
+
+	void SerializeBody(FArchive& Ar, const int32 Depth);
+};
@@ -5,8 +5,18 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Library/SIInventoryStructLibrary.h"
+#include "WorldCollision.h"
 #include "SICharacter.generated.h"
 
+UENUM(BlueprintType)
+enum class ESIInteractionSelectionMode : uint8
+{
+	//A single line trace along the view direction
+	ISM_LineTrace UMETA(DisplayName = "Line Trace"),
+	//Nearby interactables are ranked by angle and distance, the best one is confirmed with one trace
+	ISM_ScoredCandidates UMETA(DisplayName = "Scored Candidates")
+};
+
 USTRUCT(BlueprintType)
 struct FSIInteractionData
 {
@@ -49,6 +59,7 @@ public:
 
 protected:
 
+	virtual void BeginPlay() override;
 	virtual void Restart() override;
 	virtual void Tick(float DeltaSeconds) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
@@ -102,29 +113,139 @@ public:
 	UFUNCTION(Server, Reliable)
 	void ServerRotateItem(class USIItem* Item);
 
+	UFUNCTION(BlueprintCallable, Category = "Items")
+	void SplitStack(class USIItem* Item, const int32 SplitQuantity, const FInventoryTile TargetTile);
+
+	UFUNCTION(Server, Reliable)
+	void ServerSplitStack(class USIItem* Item, const int32 SplitQuantity, const FInventoryTile TargetTile);
+
+	UFUNCTION(BlueprintCallable, Category = "Items")
+	void MergeStacks(class USIItem* SourceItem, class USIItem* TargetItem);
+
+	UFUNCTION(Server, Reliable)
+	void ServerMergeStacks(class USIItem* SourceItem, class USIItem* TargetItem);
+
+	UFUNCTION(BlueprintCallable, Category = "Items")
+	void ConsolidateStacks(USIInventoryComponent* Inventory);
+
+	UFUNCTION(Server, Reliable)
+	void ServerConsolidateStacks(USIInventoryComponent* Inventory);
+
+	//Starts receiving the contents of a container item, creating its grid on the server if needed
+	UFUNCTION(BlueprintCallable, Category = "Items")
+	void OpenContainer(class USIContainerItem* Container);
+
+	UFUNCTION(Server, Reliable)
+	void ServerOpenContainer(class USIContainerItem* Container);
+
+	UFUNCTION(BlueprintCallable, Category = "Items")
+	void CloseContainer(class USIContainerItem* Container);
+
+	UFUNCTION(Server, Reliable)
+	void ServerCloseContainer(class USIContainerItem* Container);
+
+	//Whether the inventory is one of ours, or the grid of a container we can reach
+	bool CanAccessInventory(const USIInventoryComponent* Inventory) const;
+
+	//Whether the container is on us or on an actor close enough to reach. Containers carried by other pawns only with bCanOpenOtherPawnsContainers
+	bool CanReachContainer(const class USIContainerItem* Container) const;
+
+	//Lets the player open containers carried by other pawns, like the backpack of a downed teammate
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	bool bCanOpenOtherPawnsContainers;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Item")
 	TSubclassOf<class ASIPickup> PickupClass;
+
+	//Adds an inventory loot can be routed to, like pockets, a rig or a backpack. The list stays sorted by RoutingPriority
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void AddInventory(USIInventoryComponent* Inventory);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void RemoveInventory(USIInventoryComponent* Inventory);
+
+	FORCEINLINE const TArray<USIInventoryComponent*>& GetInventoryList() const { return InventoryList; }
+
+	//Whether the inventory is one of ours, or the grid of a container in one of ours
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	bool OwnsInventory(const USIInventoryComponent* Inventory) const;
+
+	//[server] Routes the item into the inventory list, grids of containers in there included. Partial stacks are topped up
+	//first, then what is left goes to the inventories with a gap it fits in, in order, until all of it is placed.
+	//Destinations are picked from the routing summaries, so only inventories with room are searched. The item is left
+	//with the quantity that didn't fit
+	FSIItemAddResult TryAddItemToInventories(class USIItem* Item);
+
+protected:
+
+	//Every inventory loot can go to, in the order it is tried
+	UPROPERTY(Transient)
+	TArray<USIInventoryComponent*> InventoryList;
+
+	//Keeps the grids of the containers in our inventories in the list, so loot is routed into backpacks too
+	void HandleInventoryItemAdded(class USIItem* Item, const FInventoryTile& Tile);
+	void HandleInventoryItemRemoved(class USIItem* Item, const FInventoryTile& Tile);
+
+public:
 	
 	// Interaction
 
 public:
 
-	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
+	//Seconds between interaction checks of the locally controlled character
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction", meta = (ClampMin = 0.0))
 	float InteractionCheckFrequency;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
 	float InteractionCheckDistance;
 
+	//Extra distance the server accepts on top of the interactable's InteractionDistance, covers latency and measuring to the actor's origin
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Validation", meta = (ClampMin = 0.0))
+	float InteractionValidationTolerance;
+
+	//Half angle, in degrees, of the view cone the interact target has to be in for the server to accept it
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Validation", meta = (ClampMin = 0.0, ClampMax = 180.0))
+	float InteractionValidationHalfAngle;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Selection")
+	ESIInteractionSelectionMode InteractionSelectionMode;
+
+	//Maximum number of interactables in view kept per check, the best scored ones are kept
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Selection", meta = (ClampMin = 1, EditCondition = "InteractionSelectionMode == ESIInteractionSelectionMode::ISM_ScoredCandidates"))
+	int32 InteractionCandidateBudget;
+
+	//Half angle, in degrees, of the view cone candidates have to be in
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Selection", meta = (ClampMin = 0.0, ClampMax = 90.0, EditCondition = "InteractionSelectionMode == ESIInteractionSelectionMode::ISM_ScoredCandidates"))
+	float InteractionCandidateHalfAngle;
+
+	//How much being close to the center of the view counts towards a candidate's score
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Selection", meta = (ClampMin = 0.0, EditCondition = "InteractionSelectionMode == ESIInteractionSelectionMode::ISM_ScoredCandidates"))
+	float InteractionAngleWeight;
+
+	//How much being close to the player counts towards a candidate's score
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Selection", meta = (ClampMin = 0.0, EditCondition = "InteractionSelectionMode == ESIInteractionSelectionMode::ISM_ScoredCandidates"))
+	float InteractionDistanceWeight;
+
+	//Anti-cheat policy, also require a line of sight trace from the server's view point to the interact target
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Validation")
+	bool bValidateInteractionWithTrace;
+
+	//Synchronous version of the interaction check
 	void PerformInteractionCheck();
 
+	//Issues the async interaction trace of the locally controlled character, its result is consumed next frame
+	void RequestInteractionCheck();
+	void ConsumeInteractionCheck();
+
 	void CouldntFindInteractable();
 	void FoundNewInteractable(AActor* Actor, class USIInteractionComponent* Interactable);
 
 	void BeginInteract();
 	void EndInteract();
 
+	//The client sends the interactable it is focusing, the server only validates it
 	UFUNCTION(Server, Reliable)
-	void ServerBeginInteract();
+	void ServerBeginInteract(class USIInteractionComponent* Target);
 
 	UFUNCTION(Server, Reliable)
 	void ServerEndInteract();
@@ -136,10 +257,9 @@ public:
 
 	FORCEINLINE class USIInteractionComponent* GetInteractable() const { return InteractionData.ViewedInteractionComponent; }
 
-	FTimerHandle TimerHandle_Interact;
-
-	FORCEINLINE bool IsInteracting() const { return GetWorldTimerManager().IsTimerActive(TimerHandle_Interact); };
-	FORCEINLINE float GetRemainingInteractTime() const { return GetWorldTimerManager().GetTimerRemaining(TimerHandle_Interact); };
+	//Hold to interact progress lives in the interaction subsystem
+	bool IsInteracting() const;
+	float GetRemainingInteractTime() const;
 
 	UFUNCTION(BlueprintCallable)
 	void SetCanInteract(bool Value);
@@ -152,6 +272,18 @@ public:
 
 protected:
 
+	//[server] Checks the interactable a client asked to interact with is within reach and in front of it
+	bool ValidateInteractionTarget(class USIInteractionComponent* Target) const;
+
+	bool GetInteractionTraceParams(FVector& OutTraceStart, FVector& OutTraceEnd, FCollisionQueryParams& OutQueryParams) const;
+
+	//Ranks the interactables near the view point and returns the best one, if any
+	class USIInteractionComponent* SelectInteractionCandidate(const FVector& ViewLocation, const FVector& ViewDirection) const;
+
+	void HandleInteractionTraceResult(const FVector& TraceStart, const FHitResult* TraceHit);
+
+	FTraceHandle InteractionTraceHandle;
+
 	UPROPERTY(BlueprintReadOnly)
 	AActor* CurrentInteractingActor;
 
@@ -19,6 +19,7 @@ public:
 	ASIHUD();
 
 	virtual void BeginPlay() override;
+	virtual void DrawHUD() override;
 	
 	void CreateGameplayWidget();
 
@@ -28,6 +29,24 @@ public:
 	void OpenInventoryWidget();
 	void CloseInventoryWidget();
 
+	//Pooled tooltip of the item's tooltip class, retargeted to the item. Created the first time its class is needed
+	UFUNCTION(BlueprintCallable, Category = "Widgets")
+	class USIItemTooltipWidget* GetItemTooltip(class USIItem* Item);
+
+	//Creates one tooltip per tooltip class used in the inventory, so the first hover doesn't have to
+	void PrewarmItemTooltips(class USIInventoryComponent* Inventory);
+
+	// Interaction
+
+	//Retargets the shared interaction prompt to the given interactable and shows it
+	void ShowInteractionPrompt(class USIInteractionComponent* Interactable);
+
+	//Hides the prompt if it is showing the given interactable
+	void HideInteractionPrompt(class USIInteractionComponent* Interactable);
+
+	void RefreshInteractionPrompt(class USIInteractionComponent* Interactable);
+	void UpdateInteractionPromptProgress(class USIInteractionComponent* Interactable, const float Progress);
+
 protected:
 
 	UPROPERTY(EditDefaultsOnly, Category = "Widgets")
@@ -36,6 +55,17 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Widgets")
 	TSubclassOf<class USIInventoryWidget> InventoryWidgetClass;
 
+	UPROPERTY(EditDefaultsOnly, Category = "Widgets")
+	TSubclassOf<class USIInteractionWidget> InteractionWidgetClass;
+
+	void UpdateInteractionPromptPosition();
+
+	class USIItemTooltipWidget* FindOrCreateItemTooltip(TSubclassOf<class USIItemTooltipWidget> TooltipClass);
+
+	//One tooltip per tooltip class, shared by every item using it
+	UPROPERTY(Transient)
+	TMap<TSubclassOf<class USIItemTooltipWidget>, class USIItemTooltipWidget*> ItemTooltips;
+
 public:
 
 	UPROPERTY(BlueprintReadOnly, Category = "Widgets")
@@ -43,5 +73,9 @@ public:
 
 	UPROPERTY(BlueprintReadOnly, Category = "Widgets")
 	class USIInventoryWidget* InventoryWidget;
+
+	//The one interaction prompt, retargeted to whatever the player is focusing
+	UPROPERTY(BlueprintReadOnly, Category = "Widgets")
+	class USIInteractionWidget* InteractionWidget;
 	
 };
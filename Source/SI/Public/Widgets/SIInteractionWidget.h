@@ -22,6 +22,12 @@ public:
 	UFUNCTION(BlueprintImplementableEvent)
 	void OnUpdateInteractionWidget();
 
+	//Called with the 0-1 hold to interact progress whenever it changes, instead of the widget polling for it
+	void UpdateInteractProgress(const float Progress);
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnUpdateInteractProgress(float Progress);
+
 	UPROPERTY(BlueprintReadOnly, Category = "Interaction", meta = (ExposeOnSpawn))
 	class USIInteractionComponent* OwningInteractionComponent;
 	
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Fonts/SlateFontInfo.h"
+#include "Styling/SlateBrush.h"
+#include "SIInventoryGridStyle.generated.h"
+
+USTRUCT(BlueprintType)
+struct FSIInventoryGridStyle
+{
+	GENERATED_BODY()
+
+	//Size in slate units of a single tile of the grid
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1.0))
+	float TileSize = 50.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FSlateBrush Background;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FLinearColor GridLineColor = FLinearColor(1.f, 1.f, 1.f, 0.25f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.0))
+	float GridLineThickness = 1.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FSlateFontInfo StackCountFont;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FLinearColor StackCountColor = FLinearColor::White;
+
+	//Offset of the stack count from the bottom right corner of the item
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2D StackCountPadding = FVector2D(4.f, 2.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FLinearColor ValidPlacementColor = FLinearColor(0.f, 1.f, 0.f, 0.25f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FLinearColor InvalidPlacementColor = FLinearColor(1.f, 0.f, 0.f, 0.25f);
+
+	//Tint of the tiles the dragged item can be anchored at
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FLinearColor PlacementHighlightColor = FLinearColor(1.f, 1.f, 1.f, 0.08f);
+};
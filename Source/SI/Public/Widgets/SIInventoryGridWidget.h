@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/Widget.h"
+#include "Library/SIInventoryStructLibrary.h"
+#include "Widgets/SIInventoryGridStyle.h"
+#include "SIInventoryGridWidget.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnInventoryGridTileClicked, FInventoryTile, Tile, class USIItem*, Item, const FPointerEvent&, MouseEvent);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnInventoryGridHoverChanged, FInventoryTile, Tile, class USIItem*, Item, bool, bHovering);
+
+/**
+ * UMG wrapper of SSIInventoryGrid. Draws the whole inventory as one widget instead of a widget per tile and item.
+ */
+UCLASS()
+class SI_API USIInventoryGridWidget : public UWidget
+{
+	GENERATED_BODY()
+
+public:
+
+	USIInventoryGridWidget();
+
+	// API
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory Grid")
+	void SetInventory(class USIInventoryComponent* NewInventory);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory Grid")
+	FORCEINLINE class USIInventoryComponent* GetInventory() const { return Inventory; }
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory Grid")
+	void SetStyle(const FSIInventoryGridStyle& NewStyle);
+
+	//Hit-tests a position in absolute (screen) space, false if it isn't over a tile
+	UFUNCTION(BlueprintCallable, Category = "Inventory Grid")
+	bool GetTileAtScreenPosition(FVector2D ScreenPosition, FInventoryTile& OutTile) const;
+
+	//Returns the item under a position in absolute (screen) space
+	UFUNCTION(BlueprintCallable, Category = "Inventory Grid")
+	class USIItem* GetItemAtScreenPosition(FVector2D ScreenPosition) const;
+
+	//Shows where the item would land when dropped at the tile
+	UFUNCTION(BlueprintCallable, Category = "Inventory Grid")
+	void SetDragPreview(class USIItem* Item, FInventoryTile Tile, bool bValid);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory Grid")
+	void ClearDragPreview();
+
+	//Highlights every tile the item can be anchored at. Cheap to call every frame, the mask is only pushed when it changed
+	UFUNCTION(BlueprintCallable, Category = "Inventory Grid")
+	void SetPlacementHighlight(class USIItem* Item, bool bCurrentDimensions = false);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory Grid")
+	void ClearPlacementHighlight();
+
+	// Events
+
+	UPROPERTY(BlueprintAssignable, Category = "Inventory Grid")
+	FOnInventoryGridTileClicked OnTileClicked;
+
+	UPROPERTY(BlueprintAssignable, Category = "Inventory Grid")
+	FOnInventoryGridHoverChanged OnHoveredTileChanged;
+
+	// Config
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FSIInventoryGridStyle Style;
+
+	// UWidget
+
+	virtual void SynchronizeProperties() override;
+	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+
+#if WITH_EDITOR
+	virtual const FText GetPaletteCategory() override;
+#endif
+
+protected:
+
+	virtual TSharedRef<SWidget> RebuildWidget() override;
+
+	FReply HandleTileClicked(const FInventoryTile& Tile, const FPointerEvent& MouseEvent);
+	void HandleHoveredTileChanged(const FInventoryTile& Tile, bool bHovering);
+
+	void HandleItemAdded(class USIItem* Item, const FInventoryTile& Tile);
+	void HandleItemChanged(class USIItem* Item, const FInventoryTile& Tile);
+	void HandleItemRemoved(class USIItem* Item, const FInventoryTile& Tile);
+	void HandleItemMoved(class USIItem* Item, const FInventoryTile& FromTile, const FInventoryTile& ToTile);
+
+	void BindInventory();
+	void UnbindInventory();
+
+	//Streams in the thumbnail of an item added while the panel is open, then packs it into the atlas
+	void RequestThumbnail(class USIItem* Item);
+	void AddThumbnailToAtlas(class USIItem* Item);
+
+	UPROPERTY(Transient)
+	class USIInventoryComponent* Inventory;
+
+	TSharedPtr<class SSIInventoryGrid> MyGrid;
+
+	//What the highlighted placement mask was built for
+	TWeakObjectPtr<class USIItem> PlacementHighlightItem;
+	FIntPoint PlacementHighlightDimensions = FIntPoint::ZeroValue;
+	int32 PlacementHighlightVersion = INDEX_NONE;
+
+	FDelegateHandle ItemAddedHandle;
+	FDelegateHandle ItemRemovedHandle;
+	FDelegateHandle ItemMovedHandle;
+	FDelegateHandle ItemQuantityChangedHandle;
+	FDelegateHandle ItemRotatedHandle;
+
+	//Thumbnails being streamed in, one request per item definition
+	TMap<const class USIItemDefinition*, TSharedPtr<struct FStreamableHandle>> ThumbnailRequests;
+	
+};
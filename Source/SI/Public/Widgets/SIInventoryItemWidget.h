@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "Library/SIInventoryStructLibrary.h"
+#include "SIInventoryItemWidget.generated.h"
+
+/**
+ * Shows a single item of the inventory grid. Instances are pooled by USIInventoryWidget and retargeted to other items.
+ */
+UCLASS()
+class SI_API USIInventoryItemWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+
+	void SetItem(class USIItem* NewItem, const FInventoryTile& NewTile);
+
+	//Called when the item, its tile, quantity or rotation changed
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnItemUpdated();
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory Item")
+	class USIItem* Item;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory Item")
+	FInventoryTile Tile;
+
+protected:
+
+	virtual void NativeOnInitialized() override;
+
+	//Fetches the pooled tooltip from the HUD only when the tooltip is about to show
+	UFUNCTION()
+	class UWidget* GetItemTooltip();
+	
+};
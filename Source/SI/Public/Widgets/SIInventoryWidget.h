@@ -4,14 +4,92 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "Library/SIInventoryStructLibrary.h"
 #include "SIInventoryWidget.generated.h"
 
 /**
- * 
+ * Inventory panel. The grid itself is painted by an optional USIInventoryGridWidget named InventoryGrid.
+ * Item widgets, when an ItemWidgetClass is set, are added, updated or recycled from a pool as the inventory reports
+ * individual changes, rather than rebuilding the whole grid on every update.
  */
 UCLASS()
 class SI_API USIInventoryWidget : public UUserWidget
 {
 	GENERATED_BODY()
+
+public:
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void SetInventory(class USIInventoryComponent* NewInventory);
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	class USIInventoryComponent* Inventory;
+
+	//Hit-tests a position in absolute (screen) space against the grid, false if it isn't over a tile
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	bool GetTileAtScreenPosition(FVector2D ScreenPosition, FInventoryTile& OutTile) const;
+
+protected:
+
+	virtual void NativeOnInitialized() override;
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	virtual bool NativeOnDragOver(const FGeometry& InGeometry, const FDragDropEvent& InDragDropEvent, class UDragDropOperation* InOperation) override;
+	virtual void NativeOnDragLeave(const FDragDropEvent& InDragDropEvent, class UDragDropOperation* InOperation) override;
+	virtual bool NativeOnDrop(const FGeometry& InGeometry, const FDragDropEvent& InDragDropEvent, class UDragDropOperation* InOperation) override;
+
+	//Tile the dragged item would be anchored at, centered on the tile under the cursor
+	bool GetDropTile(class USIItem* Item, const FVector2D& ScreenPosition, FInventoryTile& OutTile) const;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory", meta = (BindWidgetOptional))
+	class USIInventoryGridWidget* InventoryGrid;
+
+	UFUNCTION()
+	void HandleGridHoverChanged(FInventoryTile Tile, class USIItem* Item, bool bHovering);
+
+	//Tooltip of the item under the cursor on the grid, fetched from the HUD pool only when the tooltip shows
+	UFUNCTION()
+	class UWidget* GetHoveredItemTooltip();
+
+	UPROPERTY(Transient)
+	class USIItem* HoveredItem;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	TSubclassOf<class USIInventoryItemWidget> ItemWidgetClass;
+
+	//Called when an item widget starts showing an item or its item moved. Place it on the grid here
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnItemWidgetPlaced(class USIInventoryItemWidget* ItemWidget, const FInventoryTile& Tile);
+
+	//Called when an item widget goes back to the pool
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnItemWidgetReleased(class USIInventoryItemWidget* ItemWidget);
+
+	void BindInventory();
+	void UnbindInventory();
+
+	//Recycles every item widget and acquires one per item, used when the inventory changed while we weren't listening
+	void SyncItemWidgets();
+
+	class USIInventoryItemWidget* AcquireItemWidget();
+	void ReleaseItemWidget(class USIInventoryItemWidget* ItemWidget);
+
+	void HandleItemAdded(class USIItem* Item, const FInventoryTile& Tile);
+	void HandleItemRemoved(class USIItem* Item, const FInventoryTile& Tile);
+	void HandleItemMoved(class USIItem* Item, const FInventoryTile& FromTile, const FInventoryTile& ToTile);
+	void HandleItemChanged(class USIItem* Item, const FInventoryTile& Tile);
+
+	UPROPERTY(Transient)
+	TMap<class USIItem*, class USIInventoryItemWidget*> ActiveItemWidgets;
+
+	UPROPERTY(Transient)
+	TArray<class USIInventoryItemWidget*> ItemWidgetPool;
+
+	FDelegateHandle ItemAddedHandle;
+	FDelegateHandle ItemRemovedHandle;
+	FDelegateHandle ItemMovedHandle;
+	FDelegateHandle ItemQuantityChangedHandle;
+	FDelegateHandle ItemRotatedHandle;
 	
 };
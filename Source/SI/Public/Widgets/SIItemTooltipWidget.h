@@ -7,7 +7,7 @@
 #include "SIItemTooltipWidget.generated.h"
 
 /**
- * 
+ * Tooltip of an item. Instances are pooled per class by ASIHUD and retargeted to whatever item is hovered.
  */
 UCLASS()
 class SI_API USIItemTooltipWidget : public UUserWidget
@@ -15,6 +15,12 @@ class SI_API USIItemTooltipWidget : public UUserWidget
 	GENERATED_BODY()
 
 public:
+
+	void SetItem(class USIItem* NewItem);
+
+	//Called whenever the tooltip is retargeted to an item, refresh anything read from the item here
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnUpdateTooltip();
 	
 	UPROPERTY(BlueprintReadOnly, Category = "Tooltip Item", meta = (ExposeOnSpawn = true))
 	class USIItem* Item;
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Library/SIInventoryStructLibrary.h"
+#include "Widgets/SIInventoryGridStyle.h"
+#include "UObject/GCObject.h"
+#include "Widgets/SLeafWidget.h"
+
+class UMaterialInterface;
+class USIInventoryComponent;
+class USIItem;
+class USIThumbnailAtlasSubsystem;
+
+DECLARE_DELEGATE_RetVal_TwoParams(FReply, FOnSIInventoryGridClicked, const FInventoryTile& /*Tile*/, const FPointerEvent& /*MouseEvent*/);
+DECLARE_DELEGATE_TwoParams(FOnSIInventoryGridHoverChanged, const FInventoryTile& /*Tile*/, bool /*bHovering*/);
+
+/**
+ * Paints a whole inventory, grid lines, item thumbnails, stack counts and the drag preview, in a single OnPaint.
+ * Only the tiles inside the culling rect are drawn, and items are bucketed in chunks so only the chunks on screen are
+ * walked. Big containers inside a scroll box cost what is on screen.
+ * Thumbnails come from the shared thumbnail atlas, so all items batch together.
+ */
+class SI_API SSIInventoryGrid : public SLeafWidget, public FGCObject
+{
+public:
+
+	SLATE_BEGIN_ARGS(SSIInventoryGrid)
+	{}
+		SLATE_ARGUMENT(FSIInventoryGridStyle, Style)
+		SLATE_EVENT(FOnSIInventoryGridClicked, OnTileClicked)
+		SLATE_EVENT(FOnSIInventoryGridHoverChanged, OnHoveredTileChanged)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	// API
+
+	void SetInventory(USIInventoryComponent* InInventory);
+	void SetStyle(const FSIInventoryGridStyle& InStyle);
+
+	//Rebuilds the cached items from the inventory
+	void RefreshItems();
+
+	//Adds or updates the cached draw data of a single item
+	void UpdateItem(USIItem* Item, const FInventoryTile& Tile);
+	void RemoveItem(USIItem* Item);
+
+	void SetDragPreview(USIItem* Item, const FInventoryTile& Tile, const bool bValid);
+	void ClearDragPreview();
+
+	//Tints every tile set in the mask, used to show where the dragged item can be anchored
+	void SetPlacementHighlight(const TBitArray<>& InPlacementMask);
+	void ClearPlacementHighlight();
+
+	//Hit-tests a screen space position against the grid. False when it isn't over a tile
+	bool GetTileAtPosition(const FGeometry& Geometry, const FVector2D& ScreenPosition, FInventoryTile& OutTile) const;
+
+	// SWidget
+
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual void OnMouseLeave(const FPointerEvent& MouseEvent) override;
+
+	// FGCObject
+
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("SSIInventoryGrid"); }
+
+protected:
+
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+
+	struct FGridItem
+	{
+		TWeakObjectPtr<USIItem> Item;
+		FInventoryTile Tile;
+		FIntPoint Dimensions;
+		bool bRotated = false;
+		FString QuantityText;
+		FVector2D QuantityTextSize;
+	};
+
+	struct FDragPreview
+	{
+		TWeakObjectPtr<USIItem> Item;
+		FInventoryTile Tile;
+		bool bValid = false;
+	};
+
+	void CacheItem(FGridItem& GridItem, USIItem* Item, const FInventoryTile& Tile) const;
+
+	//Region of the thumbnail atlas when the thumbnail is in it, otherwise a brush drawing the thumbnail material on its own.
+	//Thumbnails still streaming in are skipped until they load
+	const FSlateBrush* GetThumbnailBrush(const USIItem* Item) const;
+
+	//Rotated thumbnails are drawn as the unrotated image turned a quarter, so no rotated thumbnail assets are needed
+	void DrawThumbnail(FSlateWindowElementList& OutDrawElements, int32 LayerId, const FGeometry& AllottedGeometry, const FSlateBrush* Brush, const FVector2D& Position, const FVector2D& Size, const bool bRotated, ESlateDrawEffect DrawEffects, const FLinearColor& Tint) const;
+
+	TWeakObjectPtr<USIInventoryComponent> Inventory;
+
+	TWeakObjectPtr<USIThumbnailAtlasSubsystem> ThumbnailAtlas;
+
+	FSIInventoryGridStyle Style;
+
+	TArray<FGridItem> GridItems;
+
+	//Indices into GridItems bucketed by the chunk of their anchor tile, same chunk size as the inventory storage
+	static constexpr int32 BucketSize = 8;
+
+	void RebuildItemBuckets() const;
+
+	mutable TMap<FIntPoint, TArray<int32>> ItemBuckets;
+
+	//Largest width or height among the cached items, how far an item can reach out of its bucket
+	mutable int32 MaxItemExtent = 1;
+
+	mutable bool bItemBucketsDirty = true;
+
+	TOptional<FDragPreview> DragPreview;
+
+	TOptional<FInventoryTile> HoveredTile;
+
+	TBitArray<> PlacementHighlight;
+
+	mutable TMap<UMaterialInterface*, FSlateBrush> ThumbnailBrushes;
+
+	//Scratch buffer for the grid lines, kept around so painting doesn't allocate
+	mutable TArray<FVector2D> LinePoints;
+
+	FOnSIInventoryGridClicked OnTileClicked;
+	FOnSIInventoryGridHoverChanged OnHoveredTileChanged;
+};
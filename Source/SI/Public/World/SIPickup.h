@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
 #include "GameFramework/Actor.h"
 #include "SIPickup.generated.h"
 
@@ -21,6 +22,20 @@ public:
 	UFUNCTION(BlueprintImplementableEvent)
 	void AlignWithGround();
 
+	//Places the pickup on the ground hit found by the pickup subsystem's batched ground traces
+	void ApplyGroundAlignment(const FHitResult& GroundHit);
+
+	//Align dropped pickups with the native batched async ground traces. Clear it to call the AlignWithGround event instead
+	UPROPERTY(EditDefaultsOnly, Category = "Pickup")
+	bool bUseNativeGroundAlignment = true;
+
+	//Size of one inventory tile of the item in centimetres, for the interaction collision of dedicated servers
+	UPROPERTY(EditDefaultsOnly, Category = "Pickup", meta = (ClampMin = 1.0))
+	float CollisionTileSize = 15.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Pickup", meta = (ClampMin = 1.0))
+	float CollisionHeight = 20.f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Instanced)
 	class USIItem* ItemTemplate;
 
@@ -38,7 +53,13 @@ protected:
 	UFUNCTION()
 	void OnItemModified();
 
+	void OnPickupMeshLoaded();
+
+	//Keeps the item's mesh loaded while this pickup shows it
+	TSharedPtr<FStreamableHandle> PickupMeshHandle;
+
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual bool ReplicateSubobjects(class UActorChannel *Channel, class FOutBunch *Bunch, FReplicationFlags *RepFlags) override;
 
@@ -49,6 +70,10 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Components")
 	class UStaticMeshComponent* PickupMesh;
 
+	//Stands in for the collision of the mesh on dedicated servers, which never load it. Sized from the item's dimensions
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Components")
+	class UBoxComponent* InteractionCollision;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Components")
 	class USIInteractionComponent* InteractionComponent;
 
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "SIPickupSubsystem.generated.h"
+
+USTRUCT()
+struct FSIDroppedPickup
+{
+	GENERATED_BODY()
+
+	FSIDroppedPickup() {};
+	FSIDroppedPickup(class ASIPickup* InPickup, float InDropTime) : Pickup(InPickup), DropTime(InDropTime) {};
+
+	UPROPERTY()
+	TWeakObjectPtr<class ASIPickup> Pickup;
+
+	UPROPERTY()
+	float DropTime = 0.f;
+};
+
+USTRUCT()
+struct FSIGroundAlignmentTrace
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TWeakObjectPtr<class ASIPickup> Pickup;
+
+	FTraceHandle Handle;
+};
+
+/**
+ * Bookkeeping for pickups dropped at runtime.
+ * On the server, dropped pickups are kept in drop order and despawned once they expire, working through a bounded
+ * number of pickups per frame instead of giving every pickup its own timer or tick.
+ * Dropped pickups are placed on the ground with batched async traces, resolved on the frame after they are queued.
+ */
+UCLASS(Config = Game)
+class SI_API USIPickupSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	// API
+
+	//[server] Starts tracking the lifetime of a pickup that was dropped at runtime
+	void RegisterDroppedPickup(class ASIPickup* Pickup);
+
+	//[server] Stops tracking a pickup, called when it is taken or destroyed
+	void UnregisterDroppedPickup(class ASIPickup* Pickup);
+
+	FORCEINLINE int32 GetNumDroppedPickups() const { return DroppedPickups.Num(); }
+
+	//Queues a pickup to be placed on the ground. The trace is issued asynchronously and applied next frame
+	void RequestGroundAlignment(class ASIPickup* Pickup);
+
+	// Config
+
+	//Seconds a dropped pickup lives before it is eligible for cleanup
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Pickup Cleanup", meta = (ClampMin = 0.0))
+	float PickupLifetime = 300.f;
+
+	//Extra seconds an expired pickup is kept alive while a player can see it. After that it is removed anyway
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Pickup Cleanup", meta = (ClampMin = 0.0))
+	float MaxVisibleLifetimeExtension = 120.f;
+
+	//Maximum number of dropped pickups alive at once. The oldest ones are evicted first when exceeded
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Pickup Cleanup", meta = (ClampMin = 1))
+	int32 MaxDroppedPickups = 512;
+
+	//How many pickups the cleanup is allowed to look at per frame
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Pickup Cleanup", meta = (ClampMin = 1))
+	int32 MaxPickupsCheckedPerFrame = 16;
+
+	//Pickups further than this from every player are considered not visible
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Pickup Cleanup", meta = (ClampMin = 0.0))
+	float VisibilityDistance = 5000.f;
+
+	//Half angle, in degrees, of the view cone used to decide if a player can see a pickup
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Pickup Cleanup", meta = (ClampMin = 0.0, ClampMax = 180.0))
+	float VisibilityHalfAngle = 60.f;
+
+	//How far below the pickup we look for the ground
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Ground Alignment", meta = (ClampMin = 0.0))
+	float GroundTraceDistance = 1000.f;
+
+	//How far above the pickup the ground trace starts, so pickups spawned slightly inside the floor still find it
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Ground Alignment", meta = (ClampMin = 0.0))
+	float GroundTraceUpOffset = 50.f;
+
+	//Maximum number of ground traces issued per frame. Mass drops are spread over the following frames
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Ground Alignment", meta = (ClampMin = 1))
+	int32 MaxGroundTracesPerFrame = 64;
+
+protected:
+
+	struct FSIPickupViewer
+	{
+		FVector Location;
+		FVector Direction;
+	};
+
+	void GatherViewers(TArray<FSIPickupViewer, TInlineAllocator<8>>& OutViewers) const;
+
+	bool IsVisibleToAnyViewer(const class ASIPickup* Pickup, const TArray<FSIPickupViewer, TInlineAllocator<8>>& Viewers) const;
+
+	void DespawnPickupAt(const int32 Index);
+
+	void TickLifetime(UWorld* World);
+	void TickGroundAlignment(UWorld* World);
+
+	//Sorted by drop time, so the expired pickups are always a prefix of this array
+	UPROPERTY()
+	TArray<FSIDroppedPickup> DroppedPickups;
+
+	//Where the expiry pass resumes on the next frame, so visible pickups don't block the ones behind them
+	int32 ExpiryCursor = 0;
+
+	//Pickups waiting for their ground trace to be issued
+	UPROPERTY()
+	TArray<TWeakObjectPtr<class ASIPickup>> PendingGroundAlignments;
+
+	//Traces issued last frame, their results are read this frame
+	UPROPERTY()
+	TArray<FSIGroundAlignmentTrace> GroundAlignmentTraces;
+
+};
@@ -10,5 +10,6 @@ public class SIEditorTarget : TargetRules
 		Type = TargetType.Editor;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
 		ExtraModuleNames.Add("SI");
+		ExtraModuleNames.Add("SITests");
 	}
 }
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SIInventoryCore.h"
+
+namespace SIInventory
+{
+	void BuildPlacementMask(const FGridShape& Shape, const TBitArray<>& Occupied, const FIntPoint Dimensions, TBitArray<>& OutMask)
+	{
+		OutMask.Init(false, FMath::Max(Shape.GetCapacity(), 0));
+
+		if (Shape.IsEmpty() || Occupied.Num() < Shape.GetCapacity() || Dimensions.X <= 0 || Dimensions.Y <= 0)
+		{
+			return;
+		}
+
+		// Summed-area table of the occupied tiles, one row and column bigger so the borders need no special case
+		const int32 Stride = Shape.Columns + 1;
+
+		TArray<int32> Sums;
+		Sums.SetNumZeroed(Stride * (Shape.Rows + 1));
+
+		for (int32 Y = 1; Y <= Shape.Rows; Y++)
+		{
+			for (int32 X = 1; X <= Shape.Columns; X++)
+			{
+				const int32 Tile = Occupied[(Y - 1) * Shape.Columns + X - 1] ? 1 : 0;
+
+				Sums[Y * Stride + X] = Tile + Sums[(Y - 1) * Stride + X] + Sums[Y * Stride + X - 1] - Sums[(Y - 1) * Stride + X - 1];
+			}
+		}
+
+		// An anchor is valid when the footprint stays in the grid and covers no occupied tile
+		const int32 Width = Dimensions.X;
+		const int32 Height = Dimensions.Y;
+
+		for (int32 Y = 0; Y + Height <= Shape.Rows; Y++)
+		{
+			for (int32 X = 0; X + Width <= Shape.Columns; X++)
+			{
+				const int32 OccupiedInFootprint = Sums[(Y + Height) * Stride + X + Width] - Sums[Y * Stride + X + Width] - Sums[(Y + Height) * Stride + X] + Sums[Y * Stride + X];
+
+				if (OccupiedInFootprint == 0)
+				{
+					OutMask[Shape.TileToIndex(FIntPoint(X, Y))] = true;
+				}
+			}
+		}
+	}
+
+	void BuildFreeSpace(const FGridShape& Shape, const TBitArray<>& Occupied, int32& OutFreeTiles, TArray<int32, TInlineAllocator<32>>& OutMaxWidthForHeight)
+	{
+		OutFreeTiles = 0;
+		OutMaxWidthForHeight.Init(0, FMath::Max(Shape.Rows, 0));
+
+		if (Shape.IsEmpty() || Occupied.Num() < Shape.GetCapacity())
+		{
+			return;
+		}
+
+		// Largest rectangle in a histogram, row by row. Heights[X] is how many empty tiles are stacked up to this row, and every
+		// maximal empty rectangle is found as some bar stretched left and right as far as the bars are at least as tall
+		TArray<int32> Heights;
+		Heights.SetNumZeroed(Shape.Columns + 1);
+
+		TArray<int32, TInlineAllocator<64>> Bars;
+
+		for (int32 Y = 0; Y < Shape.Rows; Y++)
+		{
+			for (int32 X = 0; X < Shape.Columns; X++)
+			{
+				if (Occupied[Y * Shape.Columns + X])
+				{
+					Heights[X] = 0;
+				}
+				else
+				{
+					Heights[X]++;
+					OutFreeTiles++;
+				}
+			}
+
+			Bars.Reset();
+
+			// The extra zero height column at the end flushes every bar still open
+			for (int32 X = 0; X <= Shape.Columns; X++)
+			{
+				while (Bars.Num() > 0 && Heights[Bars.Last()] >= Heights[X])
+				{
+					const int32 Height = Heights[Bars.Pop(false)];
+					const int32 Width = Bars.Num() > 0 ? X - Bars.Last() - 1 : X;
+
+					if (Height > 0)
+					{
+						int32& MaxWidth = OutMaxWidthForHeight[Height - 1];
+						MaxWidth = FMath::Max(MaxWidth, Width);
+					}
+				}
+
+				Bars.Add(X);
+			}
+		}
+
+		// A rectangle that fits a taller item fits every shorter one of the same width
+		for (int32 Height = Shape.Rows - 1; Height > 0; Height--)
+		{
+			int32& MaxWidth = OutMaxWidthForHeight[Height - 1];
+			MaxWidth = FMath::Max(MaxWidth, OutMaxWidthForHeight[Height]);
+		}
+	}
+}
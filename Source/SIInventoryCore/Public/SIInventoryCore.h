@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Grid, placement, stacking and weight rules of an inventory, as plain functions over sizes, indices and occupancy bits.
+ * Nothing in here needs a world, an actor or an item object, the SIInventoryCore module only depends on Core.
+ * USIInventoryComponent answers its placement and capacity questions through these, so they can also be exercised on
+ * their own, see the SIInventoryCoreTests program.
+ */
+namespace SIInventory
+{
+	/**Size of a grid and the conversions between tiles and indices, row by row from the top left*/
+	struct FGridShape
+	{
+		FGridShape() {};
+		FGridShape(const int32 InRows, const int32 InColumns) : Rows(InRows), Columns(InColumns) {};
+
+		int32 Rows = 0;
+		int32 Columns = 0;
+
+		FORCEINLINE int32 GetCapacity() const { return Rows * Columns; }
+
+		FORCEINLINE bool IsEmpty() const { return Rows <= 0 || Columns <= 0; }
+
+		FORCEINLINE bool IsTileValid(const FIntPoint Tile) const { return Tile.X >= 0 && Tile.Y >= 0 && Tile.X < Columns && Tile.Y < Rows; }
+
+		FORCEINLINE bool IsIndexValid(const int32 Index) const { return Index >= 0 && Index < GetCapacity(); }
+
+		FORCEINLINE int32 TileToIndex(const FIntPoint Tile) const { return Tile.X + Tile.Y * Columns; }
+
+		FORCEINLINE FIntPoint IndexToTile(const int32 Index) const { return FIntPoint(Index % Columns, Index / Columns); }
+
+		//True when an item of these dimensions anchored at the tile stays inside the grid
+		FORCEINLINE bool ContainsFootprint(const FIntPoint Anchor, const FIntPoint Dimensions) const
+		{
+			return Anchor.X >= 0 && Anchor.Y >= 0 && Dimensions.X > 0 && Dimensions.Y > 0 && Anchor.X + Dimensions.X <= Columns && Anchor.Y + Dimensions.Y <= Rows;
+		}
+	};
+
+	//True when the footprint anchored at the index is inside the grid and IsBlocked is false for every tile it covers.
+	//IsBlocked gets the index of a tile and decides what counts as taken, like any item but the one being moved
+	template<typename IsBlockedType>
+	bool IsRoomAvailable(const FGridShape& Shape, const int32 AnchorIndex, const FIntPoint Dimensions, IsBlockedType&& IsBlocked)
+	{
+		if (!Shape.IsIndexValid(AnchorIndex))
+		{
+			return false;
+		}
+
+		const FIntPoint Anchor = Shape.IndexToTile(AnchorIndex);
+
+		if (!Shape.ContainsFootprint(Anchor, Dimensions))
+		{
+			return false;
+		}
+
+		for (int32 Y = Anchor.Y; Y < Anchor.Y + Dimensions.Y; Y++)
+		{
+			for (int32 X = Anchor.X; X < Anchor.X + Dimensions.X; X++)
+			{
+				if (IsBlocked(Shape.TileToIndex(FIntPoint(X, Y))))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	//Sets the bit of every anchor index a footprint of these dimensions fits at, given which tiles are taken.
+	//One pass over the grid with a summed-area table, whatever the size of the footprint
+	SIINVENTORYCORE_API void BuildPlacementMask(const FGridShape& Shape, const TBitArray<>& Occupied, const FIntPoint Dimensions, TBitArray<>& OutMask);
+
+	//Counts the free tiles and finds, for every height, the widest empty rectangle at least that tall
+	SIINVENTORYCORE_API void BuildFreeSpace(const FGridShape& Shape, const TBitArray<>& Occupied, int32& OutFreeTiles, TArray<int32, TInlineAllocator<32>>& OutMaxWidthForHeight);
+
+	//How many of Quantity fit in the weight left, when each weighs UnitWeight. Weightless items always fit, and none do
+	//once an inventory is over its capacity
+	FORCEINLINE int32 GetMaxQuantityForWeight(const float RemainingWeight, const float UnitWeight, const int32 Quantity)
+	{
+		return FMath::IsNearlyZero(UnitWeight) ? Quantity : FMath::Clamp(FMath::FloorToInt(RemainingWeight / UnitWeight), 0, Quantity);
+	}
+
+	//Room left on a stack
+	FORCEINLINE int32 GetStackRoom(const int32 StackQuantity, const int32 MaxStackSize)
+	{
+		return FMath::Max(MaxStackSize - StackQuantity, 0);
+	}
+
+	//How many of Quantity go onto a stack, limited by its room and the weight left in the inventory
+	FORCEINLINE int32 GetStackAddAmount(const int32 StackQuantity, const int32 MaxStackSize, const int32 Quantity, const float RemainingWeight, const float UnitWeight)
+	{
+		return GetMaxQuantityForWeight(RemainingWeight, UnitWeight, FMath::Min(GetStackRoom(StackQuantity, MaxStackSize), Quantity));
+	}
+
+	//How many of Quantity go into a new stack on an empty spot
+	FORCEINLINE int32 GetNewStackAmount(const int32 MaxStackSize, const int32 Quantity, const float RemainingWeight, const float UnitWeight)
+	{
+		return GetMaxQuantityForWeight(RemainingWeight, UnitWeight, FMath::Min(MaxStackSize, Quantity));
+	}
+
+	FORCEINLINE float GetStackWeight(const float UnitWeight, const int32 Quantity)
+	{
+		return Quantity * UnitWeight;
+	}
+}
@@ -0,0 +1,14 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class SIInventoryCore : ModuleRules
+{
+	public SIInventoryCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// Only Core, so the rules can be built and tested without the engine
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}
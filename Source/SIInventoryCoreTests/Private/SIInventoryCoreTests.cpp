@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SIInventoryCore.h"
+
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SIInventoryCoreTests
+{
+	//Occupancy bits of a grid from rows of '.' for free and 'X' for taken tiles
+	static TBitArray<> MakeOccupancy(const TArray<FString>& Rows)
+	{
+		TBitArray<> Occupied;
+
+		for (const FString& Row : Rows)
+		{
+			for (const TCHAR Tile : Row)
+			{
+				Occupied.Add(Tile == TEXT('X'));
+			}
+		}
+
+		return Occupied;
+	}
+
+	static TBitArray<> MakeRandomOccupancy(const SIInventory::FGridShape& Shape, FRandomStream& Random, const float TakenChance)
+	{
+		TBitArray<> Occupied;
+
+		for (int32 Index = 0; Index < Shape.GetCapacity(); Index++)
+		{
+			Occupied.Add(Random.FRand() < TakenChance);
+		}
+
+		return Occupied;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIInventoryCoreGridShapeTest, "SI.Core.GridShape", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSIInventoryCoreGridShapeTest::RunTest(const FString& Parameters)
+{
+	const SIInventory::FGridShape Shape(3, 4);
+
+	TestEqual(TEXT("Capacity"), Shape.GetCapacity(), 12);
+	TestTrue(TEXT("A grid without rows is empty"), SIInventory::FGridShape(0, 4).IsEmpty());
+
+	TestEqual(TEXT("Tiles go row by row"), Shape.TileToIndex(FIntPoint(1, 2)), 9);
+	TestTrue(TEXT("Indices go back to the same tile"), Shape.IndexToTile(9) == FIntPoint(1, 2));
+
+	TestTrue(TEXT("The last tile is valid"), Shape.IsTileValid(FIntPoint(3, 2)));
+	TestFalse(TEXT("A tile past the last column is not"), Shape.IsTileValid(FIntPoint(4, 0)));
+	TestFalse(TEXT("An index past the end is not"), Shape.IsIndexValid(12));
+
+	TestTrue(TEXT("A footprint touching the borders is inside"), Shape.ContainsFootprint(FIntPoint(2, 1), FIntPoint(2, 2)));
+	TestFalse(TEXT("A footprint over the right border is not"), Shape.ContainsFootprint(FIntPoint(3, 0), FIntPoint(2, 1)));
+	TestFalse(TEXT("A footprint without area is not"), Shape.ContainsFootprint(FIntPoint(0, 0), FIntPoint(0, 1)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIInventoryCoreRoomTest, "SI.Core.IsRoomAvailable", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSIInventoryCoreRoomTest::RunTest(const FString& Parameters)
+{
+	const SIInventory::FGridShape Shape(3, 4);
+	const TBitArray<> Occupied = SIInventoryCoreTests::MakeOccupancy({ TEXT("...."), TEXT(".X.."), TEXT("....") });
+
+	auto IsBlocked = [&Occupied](const int32 Index) { return Occupied[Index]; };
+
+	TestTrue(TEXT("A free spot has room"), SIInventory::IsRoomAvailable(Shape, Shape.TileToIndex(FIntPoint(2, 0)), FIntPoint(2, 2), IsBlocked));
+	TestFalse(TEXT("A footprint over a taken tile has none"), SIInventory::IsRoomAvailable(Shape, Shape.TileToIndex(FIntPoint(0, 0)), FIntPoint(2, 2), IsBlocked));
+	TestFalse(TEXT("A footprint leaving the grid has none"), SIInventory::IsRoomAvailable(Shape, Shape.TileToIndex(FIntPoint(3, 0)), FIntPoint(2, 1), IsBlocked));
+	TestFalse(TEXT("An anchor outside the grid has none"), SIInventory::IsRoomAvailable(Shape, INDEX_NONE, FIntPoint(1, 1), IsBlocked));
+	TestFalse(TEXT("An anchor past the end has none"), SIInventory::IsRoomAvailable(Shape, Shape.GetCapacity(), FIntPoint(1, 1), IsBlocked));
+
+	// The predicate decides what counts as taken, like the tiles of the item being moved
+	const int32 MovedIndex = Shape.TileToIndex(FIntPoint(1, 1));
+
+	TestTrue(TEXT("Tiles the predicate ignores are free"), SIInventory::IsRoomAvailable(Shape, Shape.TileToIndex(FIntPoint(0, 0)), FIntPoint(2, 2), [&Occupied, MovedIndex](const int32 Index)
+	{
+		return Index != MovedIndex && Occupied[Index];
+	}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIInventoryCorePlacementMaskTest, "SI.Core.PlacementMask", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSIInventoryCorePlacementMaskTest::RunTest(const FString& Parameters)
+{
+	const SIInventory::FGridShape Shape(3, 4);
+	const TBitArray<> Occupied = SIInventoryCoreTests::MakeOccupancy({ TEXT("...."), TEXT(".X.."), TEXT("....") });
+
+	TBitArray<> Mask;
+	SIInventory::BuildPlacementMask(Shape, Occupied, FIntPoint(2, 2), Mask);
+
+	TestEqual(TEXT("The mask covers the grid"), Mask.Num(), Shape.GetCapacity());
+	TestEqual(TEXT("Only the two anchors right of the taken tile fit a 2x2"), Mask.CountSetBits(), 2);
+	TestTrue(TEXT("Top anchor"), Mask[Shape.TileToIndex(FIntPoint(2, 0))]);
+	TestTrue(TEXT("Bottom anchor"), Mask[Shape.TileToIndex(FIntPoint(2, 1))]);
+
+	SIInventory::BuildPlacementMask(Shape, Occupied, FIntPoint(5, 1), Mask);
+	TestEqual(TEXT("A footprint wider than the grid fits nowhere"), Mask.CountSetBits(), 0);
+
+	SIInventory::BuildPlacementMask(Shape, Occupied, FIntPoint(0, 1), Mask);
+	TestEqual(TEXT("A footprint without area fits nowhere"), Mask.CountSetBits(), 0);
+
+	SIInventory::BuildPlacementMask(Shape, TBitArray<>(false, 4), FIntPoint(1, 1), Mask);
+	TestEqual(TEXT("Occupancy shorter than the grid fits nowhere"), Mask.CountSetBits(), 0);
+
+	// The summed-area mask agrees with checking every anchor tile by tile
+	FRandomStream Random(7);
+
+	for (int32 Round = 0; Round < 20; Round++)
+	{
+		const SIInventory::FGridShape RandomShape(Random.RandRange(1, 12), Random.RandRange(1, 12));
+		const TBitArray<> RandomOccupied = SIInventoryCoreTests::MakeRandomOccupancy(RandomShape, Random, 0.3f);
+
+		auto IsBlocked = [&RandomOccupied](const int32 Index) { return RandomOccupied[Index]; };
+
+		for (int32 Width = 1; Width <= 3; Width++)
+		{
+			for (int32 Height = 1; Height <= 3; Height++)
+			{
+				SIInventory::BuildPlacementMask(RandomShape, RandomOccupied, FIntPoint(Width, Height), Mask);
+
+				for (int32 Index = 0; Index < RandomShape.GetCapacity(); Index++)
+				{
+					if (Mask[Index] != SIInventory::IsRoomAvailable(RandomShape, Index, FIntPoint(Width, Height), IsBlocked))
+					{
+						AddError(FString::Printf(TEXT("Mask disagrees at index %d for %dx%d on a %dx%d grid"), Index, Width, Height, RandomShape.Columns, RandomShape.Rows));
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIInventoryCoreFreeSpaceTest, "SI.Core.FreeSpace", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSIInventoryCoreFreeSpaceTest::RunTest(const FString& Parameters)
+{
+	const SIInventory::FGridShape Shape(3, 4);
+
+	int32 FreeTiles = 0;
+	TArray<int32, TInlineAllocator<32>> MaxWidthForHeight;
+
+	SIInventory::BuildFreeSpace(Shape, SIInventoryCoreTests::MakeOccupancy({ TEXT("...."), TEXT(".X.."), TEXT("....") }), FreeTiles, MaxWidthForHeight);
+
+	TestEqual(TEXT("Every tile but the taken one is free"), FreeTiles, 11);
+
+	if (TestEqual(TEXT("One width per height"), MaxWidthForHeight.Num(), 3))
+	{
+		TestEqual(TEXT("A full row is free"), MaxWidthForHeight[0], 4);
+		TestEqual(TEXT("Two tall, the columns right of the taken tile"), MaxWidthForHeight[1], 2);
+		TestEqual(TEXT("Three tall, the same columns"), MaxWidthForHeight[2], 2);
+	}
+
+	SIInventory::BuildFreeSpace(Shape, TBitArray<>(true, Shape.GetCapacity()), FreeTiles, MaxWidthForHeight);
+
+	TestEqual(TEXT("A full grid has no free tiles"), FreeTiles, 0);
+	TestEqual(TEXT("A full grid fits nothing"), MaxWidthForHeight[0], 0);
+
+	// The widest rectangle for a height is the widest footprint of that height the placement mask finds a spot for
+	FRandomStream Random(11);
+	TBitArray<> Mask;
+
+	for (int32 Round = 0; Round < 20; Round++)
+	{
+		const SIInventory::FGridShape RandomShape(Random.RandRange(1, 10), Random.RandRange(1, 10));
+		const TBitArray<> RandomOccupied = SIInventoryCoreTests::MakeRandomOccupancy(RandomShape, Random, 0.25f);
+
+		SIInventory::BuildFreeSpace(RandomShape, RandomOccupied, FreeTiles, MaxWidthForHeight);
+
+		TestEqual(TEXT("Free tiles are the ones not taken"), FreeTiles, RandomShape.GetCapacity() - RandomOccupied.CountSetBits());
+
+		for (int32 Height = 1; Height <= RandomShape.Rows; Height++)
+		{
+			int32 WidestFit = 0;
+
+			for (int32 Width = 1; Width <= RandomShape.Columns; Width++)
+			{
+				SIInventory::BuildPlacementMask(RandomShape, RandomOccupied, FIntPoint(Width, Height), Mask);
+
+				if (Mask.Find(true) != INDEX_NONE)
+				{
+					WidestFit = Width;
+				}
+			}
+
+			if (MaxWidthForHeight[Height - 1] != WidestFit)
+			{
+				AddError(FString::Printf(TEXT("Widest free rectangle %d tall is %d, the placement mask fits %d on a %dx%d grid"), Height, MaxWidthForHeight[Height - 1], WidestFit, RandomShape.Columns, RandomShape.Rows));
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIInventoryCoreStackingTest, "SI.Core.StackingAndWeight", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSIInventoryCoreStackingTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("As many as the weight left carries"), SIInventory::GetMaxQuantityForWeight(10.f, 3.f, 5), 3);
+	TestEqual(TEXT("No more than were asked for"), SIInventory::GetMaxQuantityForWeight(10.f, 2.f, 3), 3);
+	TestEqual(TEXT("Weightless items always fit"), SIInventory::GetMaxQuantityForWeight(0.f, 0.f, 5), 5);
+	TestEqual(TEXT("None fit in less than one unit"), SIInventory::GetMaxQuantityForWeight(2.f, 3.f, 5), 0);
+	TestEqual(TEXT("None fit once over capacity"), SIInventory::GetMaxQuantityForWeight(-1.f, 3.f, 5), 0);
+
+	TestEqual(TEXT("Room left on a stack"), SIInventory::GetStackRoom(15, 20), 5);
+	TestEqual(TEXT("An overfull stack has no room"), SIInventory::GetStackRoom(25, 20), 0);
+
+	TestEqual(TEXT("A stack takes what it has room for"), SIInventory::GetStackAddAmount(15, 20, 10, 100.f, 1.f), 5);
+	TestEqual(TEXT("A stack takes what the weight allows"), SIInventory::GetStackAddAmount(15, 20, 10, 2.5f, 1.f), 2);
+	TestEqual(TEXT("A stack takes all of a small amount"), SIInventory::GetStackAddAmount(5, 20, 3, 100.f, 1.f), 3);
+
+	TestEqual(TEXT("A new stack is at most a full one"), SIInventory::GetNewStackAmount(20, 50, 100.f, 1.f), 20);
+	TestEqual(TEXT("A new stack takes what the weight allows"), SIInventory::GetNewStackAmount(20, 50, 7.f, 2.f), 3);
+
+	TestEqual(TEXT("Stack weight"), SIInventory::GetStackWeight(0.5f, 4), 2.f);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RequiredProgramMainCPPInclude.h"
+
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSIInventoryCoreTests, Log, All);
+
+IMPLEMENT_APPLICATION(SIInventoryCoreTests, "SIInventoryCoreTests");
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	FTaskTagScope Scope(ETaskTag::EGameThread);
+
+	ON_SCOPE_EXIT
+	{
+		RequestEngineExit(TEXT("SIInventoryCoreTests finished"));
+		FEngineLoop::AppPreExit();
+		FModuleManager::Get().UnloadModulesAtShutdown();
+		FEngineLoop::AppExit();
+	};
+
+	if (const int32 Result = GEngineLoop.PreInit(ArgC, ArgV))
+	{
+		return Result;
+	}
+
+#if WITH_DEV_AUTOMATION_TESTS
+	// Only the tests linked into this program are registered, which are the SI.Core ones unless a filter narrows them down
+	FString Filter = TEXT("SI.Core");
+	FParse::Value(FCommandLine::Get(), TEXT("-Filter="), Filter);
+
+	FAutomationTestFramework& Framework = FAutomationTestFramework::Get();
+	Framework.SetRequestedTestFilter(EAutomationTestFlags::ProductFilter);
+
+	TArray<FAutomationTestInfo> TestInfos;
+	Framework.GetValidTestNames(TestInfos);
+
+	int32 Ran = 0;
+	int32 Failed = 0;
+
+	for (const FAutomationTestInfo& TestInfo : TestInfos)
+	{
+		if (!TestInfo.GetDisplayName().StartsWith(Filter))
+		{
+			continue;
+		}
+
+		Framework.StartTestByName(TestInfo.GetTestName(), 0);
+
+		FAutomationTestExecutionInfo ExecutionInfo;
+		const bool bSucceeded = Framework.StopTest(ExecutionInfo);
+
+		for (const FAutomationExecutionEntry& Entry : ExecutionInfo.GetEntries())
+		{
+			if (Entry.Event.Type == EAutomationEventType::Error)
+			{
+				UE_LOG(LogSIInventoryCoreTests, Error, TEXT("%s: %s"), *TestInfo.GetDisplayName(), *Entry.Event.Message);
+			}
+		}
+
+		UE_LOG(LogSIInventoryCoreTests, Display, TEXT("%s %s"), bSucceeded ? TEXT("Passed") : TEXT("Failed"), *TestInfo.GetDisplayName());
+
+		Ran++;
+		Failed += bSucceeded ? 0 : 1;
+	}
+
+	UE_LOG(LogSIInventoryCoreTests, Display, TEXT("%d of %d tests passed."), Ran - Failed, Ran);
+
+	// Nothing run counts as a failure, a filter that matches nothing shouldn't pass silently
+	return Ran > 0 && Failed == 0 ? 0 : 1;
+#else
+	UE_LOG(LogSIInventoryCoreTests, Error, TEXT("Automation tests aren't compiled into this configuration."));
+
+	return 1;
+#endif
+}
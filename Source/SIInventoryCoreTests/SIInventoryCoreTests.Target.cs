@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+//Runs the SI.Core tests on their own, without loading the engine or the editor: SIInventoryCoreTests [-Filter=SI.Core]
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class SIInventoryCoreTestsTarget : TargetRules
+{
+	public SIInventoryCoreTestsTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "SIInventoryCoreTests";
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+
+		bBuildDeveloperTools = false;
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+		bCompileICU = false;
+		bIsBuildingConsoleApplication = true;
+	}
+}
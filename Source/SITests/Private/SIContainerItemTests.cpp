@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SITestFixtures.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIContainerWeightTest, "SI.Inventory.Container.Weight", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSIContainerWeightTest::RunTest(const FString& Parameters)
+{
+	SITests::FTestWorld TestWorld;
+
+	TestWorld.SetItemDefinition(USITestItem1x1::StaticClass(), FIntPoint(1, 1), 1.f, 20);
+	TestWorld.SetItemDefinition(USITestContainerItem::StaticClass(), FIntPoint(2, 2), 1.f);
+
+	USIInventoryComponent* Inventory = TestWorld.CreateInventory(6, 6, 10.f);
+
+	// A container weighing 1 with 10 weight in it, as a whole too heavy for an inventory that carries 10
+	USITestContainerItem* Backpack = Cast<USITestContainerItem>(TestWorld.MakeItem(USITestContainerItem::StaticClass()));
+	Backpack->InnerWeightCapacity = 50.f;
+
+	const FSIItemAddResult FillResult = Backpack->TryAddItemToContainer(TestWorld.MakeItem(USITestItem1x1::StaticClass(), 10));
+
+	TestEqual(TEXT("The container takes the whole stack"), FillResult.AmountGiven, 10);
+	TestEqual(TEXT("The container weighs itself and its contents"), Backpack->GetStackWeight(), 11.f);
+	TestEqual(TEXT("The unit weight counts the contents"), Backpack->GetUnitWeight(), 11.f);
+
+	const FSIItemAddResult AddFullResult = Inventory->TryAddItem(Backpack, FInventoryTile(0, 0));
+
+	TestEqual(TEXT("A filled container over the weight left isn't added at the tile asked for"), AddFullResult.AmountGiven, 0);
+	TestTrue(TEXT("Nothing was added"), Inventory->GetItemsMap().Num() == 0);
+
+	// Empty it down to fit, the same container is now light enough
+	Backpack->GetInnerInventory()->ConsumeItem(Backpack->GetInnerInventory()->FindItemByClass(USITestItem1x1::StaticClass()), 5);
+
+	const FSIItemAddResult AddResult = Inventory->TryAddItem(Backpack, FInventoryTile(0, 0));
+
+	TestEqual(TEXT("The lighter container is added"), AddResult.AmountGiven, 1);
+	TestEqual(TEXT("The inventory carries the container and its contents"), Inventory->GetCurrentWeight(), 6.f);
+
+	// The grid of the container in the inventory is limited by what the inventory has left, not only its own capacity
+	TArray<USIItem*> InventoryItems;
+	Inventory->GetItemsMap().GetKeys(InventoryItems);
+
+	USITestContainerItem* AddedBackpack = InventoryItems.Num() > 0 ? Cast<USITestContainerItem>(InventoryItems[0]) : nullptr;
+
+	if (TestNotNull(TEXT("The added container"), AddedBackpack) && TestNotNull(TEXT("Its grid came along"), AddedBackpack->GetInnerInventory()))
+	{
+		TestEqual(TEXT("The grid has the weight left in the inventory"), AddedBackpack->GetInnerInventory()->GetRemainingWeight(), 4.f);
+
+		const FSIItemAddResult TopUpResult = AddedBackpack->TryAddItemToContainer(TestWorld.MakeItem(USITestItem1x1::StaticClass(), 10));
+
+		TestEqual(TEXT("Only what the inventory can still carry goes into the container"), TopUpResult.AmountGiven, 4);
+		TestEqual(TEXT("The inventory is at its capacity"), Inventory->GetCurrentWeight(), 10.f);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIContainerLifecycleTest, "SI.Inventory.Container.Lifecycle", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSIContainerLifecycleTest::RunTest(const FString& Parameters)
+{
+	SITests::FTestWorld TestWorld;
+
+	TestWorld.SetItemDefinition(USITestItem1x1::StaticClass(), FIntPoint(1, 1), 1.f, 20);
+	TestWorld.SetItemDefinition(USITestContainerItem::StaticClass(), FIntPoint(2, 2), 1.f);
+
+	USIInventoryComponent* Inventory = TestWorld.CreateInventory(6, 6, 100.f);
+
+	USITestContainerItem* Backpack = Cast<USITestContainerItem>(TestWorld.MakeItem(USITestContainerItem::StaticClass()));
+	Backpack->TryAddItemToContainer(TestWorld.MakeItem(USITestItem1x1::StaticClass(), 5));
+
+	Inventory->TryAddItem(Backpack, FInventoryTile(0, 0));
+
+	USITestContainerItem* AddedBackpack = Cast<USITestContainerItem>(Inventory->GetItemAtTile(FInventoryTile(0, 0)));
+
+	if (!TestNotNull(TEXT("The added container"), AddedBackpack) || !TestNotNull(TEXT("Its grid came along"), AddedBackpack->GetInnerInventory()))
+	{
+		return false;
+	}
+
+	// Moving recreates the item, the grid has to be handed over rather than released
+	Inventory->TryMoveItem(AddedBackpack, FInventoryTile(3, 3));
+
+	USITestContainerItem* MovedBackpack = Cast<USITestContainerItem>(Inventory->GetItemAtTile(FInventoryTile(3, 3)));
+
+	if (!TestNotNull(TEXT("The moved container"), MovedBackpack) || !TestNotNull(TEXT("The grid moved with it"), MovedBackpack->GetInnerInventory()))
+	{
+		return false;
+	}
+
+	USIInventoryComponent* InnerInventory = MovedBackpack->GetInnerInventory();
+
+	TestTrue(TEXT("The contents moved with it"), InnerInventory->HasItem(USITestItem1x1::StaticClass(), 5));
+
+	Inventory->ConsumeItem(MovedBackpack);
+
+	TestNull(TEXT("A consumed container lets go of its grid"), MovedBackpack->GetInnerInventory());
+	TestFalse(TEXT("The grid of a consumed container is destroyed"), IsValid(InnerInventory));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,481 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SITestFixtures.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Persistence/SIInventorySnapshot.h"
+#include "SIInventoryCore.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SIInventoryBenchmark
+{
+	struct FBenchmarkCase
+	{
+		int32 Rows = 0;
+		int32 Columns = 0;
+
+		float FillRatio = 0.f;
+
+		FString ItemMix;
+		TArray<TSubclassOf<USIItem>> ItemClasses;
+	};
+
+	struct FBenchmarkResult
+	{
+		FString Operation;
+
+		int32 Iterations = 0;
+
+		double OpsPerSecond = 0.0;
+
+		//Microseconds
+		double Mean = 0.0;
+		double P50 = 0.0;
+		double P90 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+	};
+
+	//Samples are in cycles, sorted in place
+	static FBenchmarkResult MakeResult(const FString& Operation, TArray<uint64>& Samples)
+	{
+		FBenchmarkResult Result;
+		Result.Operation = Operation;
+		Result.Iterations = Samples.Num();
+
+		if (Samples.Num() == 0)
+		{
+			return Result;
+		}
+
+		Samples.Sort();
+
+		const double MicrosecondsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1000000.0;
+
+		uint64 Total = 0;
+
+		for (const uint64 Sample : Samples)
+		{
+			Total += Sample;
+		}
+
+		auto Percentile = [&Samples, MicrosecondsPerCycle](const double Fraction)
+		{
+			const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * Samples.Num()) - 1, 0, Samples.Num() - 1);
+			return Samples[Index] * MicrosecondsPerCycle;
+		};
+
+		Result.Mean = Total * MicrosecondsPerCycle / Samples.Num();
+		Result.P50 = Percentile(0.5);
+		Result.P90 = Percentile(0.9);
+		Result.P99 = Percentile(0.99);
+		Result.Max = Samples.Last() * MicrosecondsPerCycle;
+		Result.OpsPerSecond = Total > 0 ? Samples.Num() / (Total * FPlatformTime::GetSecondsPerCycle64()) : 0.0;
+
+		return Result;
+	}
+
+	//Collects the items the inventory adds while this is around, so an operation is undone by taking out only what it added
+	struct FAddedItems
+	{
+		explicit FAddedItems(USIInventoryComponent* InInventory)
+			: Inventory(InInventory)
+		{
+			Handle = Inventory->OnInventoryItemAdded.AddLambda([this](USIItem* Item, const FInventoryTile& Tile)
+			{
+				Items.Add(Item);
+			});
+		}
+
+		~FAddedItems()
+		{
+			Inventory->OnInventoryItemAdded.Remove(Handle);
+		}
+
+		USIInventoryComponent* Inventory = nullptr;
+		FDelegateHandle Handle;
+
+		TArray<USIItem*> Items;
+	};
+
+	//Adds random items of the mix at random tiles, then packs the gaps left with the smallest ones that fit until the ratio
+	//of the grid is covered. Returns the ratio actually covered, less than asked for only when nothing fits anymore
+	static float FillInventory(USIInventoryComponent* Inventory, const FBenchmarkCase& Case, FRandomStream& Random)
+	{
+		// Laid out as plain data and restored in one go, adding thousands of items one by one would take longer than the benchmark
+		const SIInventory::FGridShape Shape(Case.Rows, Case.Columns);
+		const int32 TargetTiles = FMath::FloorToInt(Shape.GetCapacity() * Case.FillRatio);
+
+		FSIInventorySnapshot Snapshot;
+		Snapshot.Rows = Case.Rows;
+		Snapshot.Columns = Case.Columns;
+
+		for (const TSubclassOf<USIItem>& ItemClass : Case.ItemClasses)
+		{
+			Snapshot.ItemTypes.Add(ItemClass->GetPathName());
+		}
+
+		TBitArray<> Occupied(false, Shape.GetCapacity());
+
+		int32 OccupiedTiles = 0;
+
+		auto TryPlace = [&](const int32 TypeId, const int32 Anchor)
+		{
+			const FIntPoint Dimensions = Case.ItemClasses[TypeId]->GetDefaultObject<USIItem>()->GetBaseDimensions();
+
+			if (!SIInventory::IsRoomAvailable(Shape, Anchor, Dimensions, [&Occupied](const int32 Index) { return Occupied[Index]; }))
+			{
+				return false;
+			}
+
+			const FIntPoint Tile = Shape.IndexToTile(Anchor);
+
+			for (int32 Y = Tile.Y; Y < Tile.Y + Dimensions.Y; Y++)
+			{
+				for (int32 X = Tile.X; X < Tile.X + Dimensions.X; X++)
+				{
+					Occupied[Shape.TileToIndex(FIntPoint(X, Y))] = true;
+				}
+			}
+
+			FSIInventorySnapshotItem& SnapshotItem = Snapshot.Items.AddDefaulted_GetRef();
+			SnapshotItem.TypeId = TypeId;
+			SnapshotItem.Anchor = Anchor;
+
+			OccupiedTiles += Dimensions.X * Dimensions.Y;
+
+			return true;
+		};
+
+		// Only the tile that was picked, so the items end up scattered rather than packed from the top left
+		for (int32 Failures = 0; OccupiedTiles < TargetTiles && Failures < 64;)
+		{
+			const int32 TypeId = Random.RandHelper(Case.ItemClasses.Num());
+			Failures = TryPlace(TypeId, Random.RandHelper(Shape.GetCapacity())) ? 0 : Failures + 1;
+		}
+
+		// Scattering leaves gaps the larger items don't fit in, the smallest ones fill them row by row
+		TArray<int32> TypesBySize;
+
+		for (int32 TypeId = 0; TypeId < Case.ItemClasses.Num(); TypeId++)
+		{
+			TypesBySize.Add(TypeId);
+		}
+
+		TypesBySize.Sort([&Case](const int32 A, const int32 B)
+		{
+			const FIntPoint DimensionsA = Case.ItemClasses[A]->GetDefaultObject<USIItem>()->GetBaseDimensions();
+			const FIntPoint DimensionsB = Case.ItemClasses[B]->GetDefaultObject<USIItem>()->GetBaseDimensions();
+
+			return DimensionsA.X * DimensionsA.Y < DimensionsB.X * DimensionsB.Y;
+		});
+
+		for (int32 Anchor = 0; Anchor < Shape.GetCapacity() && OccupiedTiles < TargetTiles; Anchor++)
+		{
+			for (const int32 TypeId : TypesBySize)
+			{
+				if (TryPlace(TypeId, Anchor))
+				{
+					break;
+				}
+			}
+		}
+
+		Inventory->RestoreSnapshot(Snapshot);
+
+		return Shape.GetCapacity() > 0 ? static_cast<float>(OccupiedTiles) / Shape.GetCapacity() : 0.f;
+	}
+
+	//Returns the ratio of the grid the case was filled to
+	static float RunCase(const SITests::FTestWorld& TestWorld, const FBenchmarkCase& Case, const int32 Iterations, const double MaxSeconds, FRandomStream& Random, TArray<FBenchmarkResult>& OutResults)
+	{
+		USIInventoryComponent* Inventory = TestWorld.CreateInventory(Case.Rows, Case.Columns, 1000000.f, Case.Rows > 20 || Case.Columns > 20);
+
+		const float FilledRatio = FillInventory(Inventory, Case, Random);
+
+		const FSIInventorySnapshot Baseline = Inventory->CreateSnapshot();
+
+		TArray<USIItem*> PlacedItems;
+		Inventory->GetItemsMap().GetKeys(PlacedItems);
+
+		// Items to place, made up front so creating them isn't timed. Only held here, so they outlive the collections between loops
+		TArray<TStrongObjectPtr<USIItem>> Candidates;
+		TArray<FInventoryTile> Tiles;
+
+		for (int32 Index = 0; Index < Iterations; Index++)
+		{
+			Candidates.Emplace(TestWorld.MakeItem(Case.ItemClasses[Random.RandHelper(Case.ItemClasses.Num())]));
+			Tiles.Add(FInventoryTile(Random.RandHelper(Case.Columns), Random.RandHelper(Case.Rows)));
+		}
+
+		// Mutating operations are undone one at a time, the items they added are taken out or moved back
+		FAddedItems Added(Inventory);
+
+		TArray<uint64> Samples;
+
+		const double AddDeadline = FPlatformTime::Seconds() + MaxSeconds;
+
+		for (int32 Index = 0; Index < Iterations && FPlatformTime::Seconds() < AddDeadline; Index++)
+		{
+			Added.Items.Reset();
+
+			const uint64 Start = FPlatformTime::Cycles64();
+			Inventory->TryAddItem(Candidates[Index].Get(), Tiles[Index]);
+			Samples.Add(FPlatformTime::Cycles64() - Start);
+
+			for (USIItem* AddedItem : Added.Items)
+			{
+				Inventory->RemoveItem(AddedItem);
+			}
+
+			Candidates[Index]->SetQuantity(1);
+		}
+
+		OutResults.Add(MakeResult(TEXT("TryAddItem"), Samples));
+
+		// The removed copies are garbage now, collected here rather than in the middle of the next timed loop
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		if (PlacedItems.Num() > 0)
+		{
+			Samples.Reset();
+
+			const double MoveDeadline = FPlatformTime::Seconds() + MaxSeconds;
+
+			for (int32 Index = 0; Index < Iterations && FPlatformTime::Seconds() < MoveDeadline; Index++)
+			{
+				const int32 ItemIndex = Random.RandHelper(PlacedItems.Num());
+				USIItem* Item = PlacedItems[ItemIndex];
+
+				FInventoryTile FromTile;
+				Inventory->GetItemTile(Item, FromTile);
+
+				Added.Items.Reset();
+
+				const uint64 Start = FPlatformTime::Cycles64();
+				Inventory->TryMoveItem(Item, Tiles[Index]);
+				Samples.Add(FPlatformTime::Cycles64() - Start);
+
+				// A moved item is replaced by a copy where it went, which is moved back to where the item was
+				if (Added.Items.Num() == 0)
+				{
+					continue;
+				}
+
+				USIItem* MovedItem = Added.Items.Last();
+				Added.Items.Reset();
+
+				Inventory->TryMoveItem(MovedItem, FromTile);
+
+				FInventoryTile BackTile;
+				USIItem* BackItem = Added.Items.Num() > 0 ? Added.Items.Last() : nullptr;
+
+				if (BackItem && Inventory->GetItemTile(BackItem, BackTile) && BackTile.X == FromTile.X && BackTile.Y == FromTile.Y)
+				{
+					PlacedItems[ItemIndex] = BackItem;
+				}
+				else
+				{
+					// Placed turned somewhere it can't go back from as it lies now, only the snapshot puts that right
+					Inventory->RestoreSnapshot(Baseline);
+
+					PlacedItems.Reset();
+					Inventory->GetItemsMap().GetKeys(PlacedItems);
+				}
+			}
+
+			OutResults.Add(MakeResult(TEXT("TryMoveItem"), Samples));
+
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+
+		Samples.Reset();
+
+		for (int32 Index = 0; Index < Iterations; Index++)
+		{
+			const int32 TopLeftIndex = Inventory->TileToIndex(Tiles[Index]);
+
+			const uint64 Start = FPlatformTime::Cycles64();
+			Inventory->IsRoomAvailable(Candidates[Index].Get(), TopLeftIndex);
+			Samples.Add(FPlatformTime::Cycles64() - Start);
+		}
+
+		OutResults.Add(MakeResult(TEXT("IsRoomAvailable"), Samples));
+
+		Samples.Reset();
+
+		for (int32 Index = 0; Index < Iterations; Index++)
+		{
+			const TSubclassOf<USIItem> ItemClass = Candidates[Index]->GetClass();
+
+			const uint64 Start = FPlatformTime::Cycles64();
+			Inventory->FindItemsByClass(ItemClass);
+			Samples.Add(FPlatformTime::Cycles64() - Start);
+		}
+
+		OutResults.Add(MakeResult(TEXT("FindItemsByClass"), Samples));
+
+		Samples.Reset();
+
+		for (int32 Index = 0; Index < Iterations; Index++)
+		{
+			// The cached value costs nothing, time the pass that follows a change
+			Inventory->MarkContentsDirty();
+
+			const uint64 Start = FPlatformTime::Cycles64();
+			Inventory->GetCurrentWeight();
+			Samples.Add(FPlatformTime::Cycles64() - Start);
+		}
+
+		OutResults.Add(MakeResult(TEXT("GetCurrentWeight"), Samples));
+
+		// The placement rules on their own, no inventory or items involved
+		const SIInventory::FGridShape Shape(Case.Rows, Case.Columns);
+
+		TBitArray<> Occupied(false, Shape.GetCapacity());
+
+		for (int32 Index = 0; Index < Shape.GetCapacity(); Index++)
+		{
+			Occupied[Index] = Inventory->GetItemAtTile(Inventory->IndexToTile(Index)) != nullptr;
+		}
+
+		TBitArray<> Mask;
+		Samples.Reset();
+
+		for (int32 Index = 0; Index < Iterations; Index++)
+		{
+			const FIntPoint Dimensions = Candidates[Index]->GetDimensions();
+
+			const uint64 Start = FPlatformTime::Cycles64();
+			SIInventory::BuildPlacementMask(Shape, Occupied, Dimensions, Mask);
+			Samples.Add(FPlatformTime::Cycles64() - Start);
+		}
+
+		OutResults.Add(MakeResult(TEXT("CoreBuildPlacementMask"), Samples));
+
+		Inventory->DestroyComponent();
+
+		return FilledRatio;
+	}
+}
+
+/**
+ * Times the inventory hot paths over a range of grid sizes, fill ratios and item size mixes, in a world of its own.
+ * Every operation is timed one call at a time, and mutating ones are undone between calls by taking out or moving back
+ * only what they changed, so every sample sees the same layout. Each operation of a case runs for at most the given
+ * iterations or seconds, whichever comes first, and garbage is only collected between the timed loops. Results go to a
+ * CSV with the fill each case actually reached, ops per second and percentiles.
+ *
+ * UnrealEditor-Cmd SI.uproject -nullrhi -ExecCmds="Automation RunTests SI.Benchmark; Quit"
+ *     [-SIBenchmarkIterations=2000] [-SIBenchmarkMaxSeconds=2] [-SIBenchmarkSeed=1] [-SIBenchmarkOutput=Path.csv]
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIInventoryBenchmarkTest, "SI.Benchmark.Inventory", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FSIInventoryBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace SIInventoryBenchmark;
+
+	int32 Iterations = 2000;
+	FParse::Value(FCommandLine::Get(), TEXT("SIBenchmarkIterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+
+	double MaxSeconds = 2.0;
+	FParse::Value(FCommandLine::Get(), TEXT("SIBenchmarkMaxSeconds="), MaxSeconds);
+
+	int32 Seed = 1;
+	FParse::Value(FCommandLine::Get(), TEXT("SIBenchmarkSeed="), Seed);
+
+	FString OutputPath;
+
+	if (!FParse::Value(FCommandLine::Get(), TEXT("SIBenchmarkOutput="), OutputPath))
+	{
+		OutputPath = FPaths::Combine(FPaths::ProfilingDir(), FString::Printf(TEXT("SIInventoryBenchmark_%s.csv"), *FDateTime::Now().ToString()));
+	}
+
+	const TArray<TPair<UClass*, FIntPoint>> Sizes = {
+		{ USITestItem1x1::StaticClass(), FIntPoint(1, 1) },
+		{ USITestItem1x2::StaticClass(), FIntPoint(1, 2) },
+		{ USITestItem2x2::StaticClass(), FIntPoint(2, 2) },
+		{ USITestItem2x3::StaticClass(), FIntPoint(2, 3) },
+		{ USITestItem3x3::StaticClass(), FIntPoint(3, 3) }
+	};
+
+	SITests::FTestWorld TestWorld;
+
+	for (const TPair<UClass*, FIntPoint>& Size : Sizes)
+	{
+		TestWorld.SetItemDefinition(Size.Key, Size.Value, 0.1f);
+	}
+
+	const TArray<TPair<int32, int32>> GridSizes = { { 6, 10 }, { 20, 20 }, { 64, 64 }, { 256, 256 } };
+	const TArray<float> FillRatios = { 0.f, 0.5f, 0.9f };
+
+	TArray<TPair<FString, TArray<TSubclassOf<USIItem>>>> ItemMixes;
+	ItemMixes.Emplace(TEXT("Small"), TArray<TSubclassOf<USIItem>>({ USITestItem1x1::StaticClass(), USITestItem1x2::StaticClass() }));
+	ItemMixes.Emplace(TEXT("Mixed"), TArray<TSubclassOf<USIItem>>({ USITestItem1x1::StaticClass(), USITestItem1x2::StaticClass(), USITestItem2x2::StaticClass(), USITestItem2x3::StaticClass() }));
+	ItemMixes.Emplace(TEXT("Large"), TArray<TSubclassOf<USIItem>>({ USITestItem2x2::StaticClass(), USITestItem2x3::StaticClass(), USITestItem3x3::StaticClass() }));
+
+	TArray<FString> Rows;
+	Rows.Add(TEXT("Operation,Rows,Columns,Storage,FillRatio,FilledRatio,ItemMix,Iterations,OpsPerSec,MeanUs,P50Us,P90Us,P99Us,MaxUs"));
+
+	FRandomStream Random;
+
+	for (const TPair<int32, int32>& GridSize : GridSizes)
+	{
+		for (const float FillRatio : FillRatios)
+		{
+			for (const TPair<FString, TArray<TSubclassOf<USIItem>>>& ItemMix : ItemMixes)
+			{
+				FBenchmarkCase Case;
+				Case.Rows = GridSize.Key;
+				Case.Columns = GridSize.Value;
+				Case.FillRatio = FillRatio;
+				Case.ItemMix = ItemMix.Key;
+				Case.ItemClasses = ItemMix.Value;
+
+				// Every case starts from the same random sequence, so runs of the same build compare
+				Random.Initialize(Seed);
+
+				TArray<FBenchmarkResult> Results;
+				const float FilledRatio = RunCase(TestWorld, Case, Iterations, MaxSeconds, Random, Results);
+
+				const FString Storage = Case.Rows > 20 || Case.Columns > 20 ? TEXT("Chunked") : TEXT("Dense");
+
+				for (const FBenchmarkResult& Result : Results)
+				{
+					Rows.Add(FString::Printf(TEXT("%s,%d,%d,%s,%.2f,%.3f,%s,%d,%.1f,%.3f,%.3f,%.3f,%.3f,%.3f"),
+						*Result.Operation, Case.Rows, Case.Columns, *Storage, Case.FillRatio, FilledRatio, *Case.ItemMix, Result.Iterations,
+						Result.OpsPerSecond, Result.Mean, Result.P50, Result.P90, Result.P99, Result.Max));
+
+					AddInfo(FString::Printf(TEXT("%s %dx%d %s %.0f%% (%.0f%% reached) %s: %.0f ops/s, p50 %.3fus, p99 %.3fus"),
+						*Result.Operation, Case.Rows, Case.Columns, *Storage, Case.FillRatio * 100.f, FilledRatio * 100.f, *Case.ItemMix, Result.OpsPerSecond, Result.P50, Result.P99));
+				}
+
+				// The items of the case are only held by its owner, drop them before the next one
+				CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			}
+		}
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(Rows, *OutputPath))
+	{
+		AddError(FString::Printf(TEXT("Couldn't write the inventory benchmark results to %s."), *OutputPath));
+		return false;
+	}
+
+	AddInfo(FString::Printf(TEXT("Wrote %d inventory benchmark results to %s."), Rows.Num() - 1, *OutputPath));
+
+	return true;
+}
+
+#endif
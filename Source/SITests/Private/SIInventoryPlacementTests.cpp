@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SITestFixtures.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSIInventoryTurnedPlacementTest, "SI.Inventory.Placement.Turned", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSIInventoryTurnedPlacementTest::RunTest(const FString& Parameters)
+{
+	SITests::FTestWorld TestWorld;
+
+	TestWorld.SetItemDefinition(USITestItem1x2::StaticClass(), FIntPoint(1, 2), 1.f);
+
+	// A column the item stands in, and a row it only fits in turned
+	USIInventoryComponent* Source = TestWorld.CreateInventory(2, 1, 10.f);
+	USIInventoryComponent* Row = TestWorld.CreateInventory(1, 3, 10.f);
+	USIInventoryComponent* Full = TestWorld.CreateInventory(1, 1, 10.f);
+
+	Source->TryAddItem(TestWorld.MakeItem(USITestItem1x2::StaticClass()), FInventoryTile(0, 0));
+
+	TArray<USIItem*> SourceItems;
+	Source->GetItemsMap().GetKeys(SourceItems);
+
+	USIItem* Item = SourceItems.Num() > 0 ? SourceItems[0] : nullptr;
+
+	if (!TestNotNull(TEXT("The item is in the source inventory"), Item))
+	{
+		return false;
+	}
+
+	// Trying both ways in an inventory it doesn't fit leaves the item as it was
+	const FSIItemAddResult FullResult = Full->TryAddItem(Item, FInventoryTile(0, 0));
+
+	TestEqual(TEXT("Nothing fits in the full inventory"), FullResult.AmountGiven, 0);
+	TestFalse(TEXT("The item isn't left turned after a failed add"), Item->GetNewRotated());
+	TestFalse(TEXT("The item isn't rotated after a failed add"), Item->GetRotated());
+
+	const FSIItemAddResult RowResult = Row->TryAddItem(Item, FInventoryTile(0, 0));
+
+	TestEqual(TEXT("The item goes in turned"), RowResult.AmountGiven, 1);
+	TestFalse(TEXT("The source item isn't turned by the trial"), Item->GetNewRotated());
+
+	TArray<USIItem*> RowItems;
+	Row->GetItemsMap().GetKeys(RowItems);
+
+	if (TestEqual(TEXT("One item in the row"), RowItems.Num(), 1))
+	{
+		TestTrue(TEXT("The copy lies turned"), RowItems[0]->GetRotated());
+		TestTrue(TEXT("The copy covers two tiles of the row"), RowItems[0]->GetDimensions() == FIntPoint(2, 1));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SITestFixtures.h"
+
+#include "Components/SIInventoryComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "UObject/Package.h"
+
+SITests::FTestWorld::FTestWorld()
+{
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SITestWorld"));
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+	World->GetWorldSettings()->NotifyBeginPlay();
+
+	Owner = World->SpawnActor<AActor>();
+}
+
+SITests::FTestWorld::~FTestWorld()
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	// The class default objects are shared by every test and the editor, leave them as they were found
+	for (const TPair<UClass*, TStrongObjectPtr<USIItemDefinition>>& Original : OriginalDefinitions)
+	{
+		Original.Key->GetDefaultObject<USIItem>()->Definition = Original.Value.Get();
+	}
+}
+
+void SITests::FTestWorld::SetItemDefinition(UClass* ItemClass, const FIntPoint Dimensions, const float Weight, const int32 MaxStackSize/* = 1*/)
+{
+	USIItem* DefaultItem = ItemClass->GetDefaultObject<USIItem>();
+
+	// Only the first swap of a class holds what it had before the test
+	if (!OriginalDefinitions.Contains(ItemClass))
+	{
+		OriginalDefinitions.Add(ItemClass, TStrongObjectPtr<USIItemDefinition>(DefaultItem->Definition));
+	}
+
+	// Kept alive by the class default object until it is restored
+	USIItemDefinition* Definition = NewObject<USIItemDefinition>(GetTransientPackage(), NAME_None, RF_Transient);
+	Definition->Dimensions = Dimensions;
+	Definition->Weight = Weight;
+	Definition->bStackable = MaxStackSize > 1;
+	Definition->MaxStackSize = MaxStackSize;
+
+	DefaultItem->Definition = Definition;
+}
+
+USIInventoryComponent* SITests::FTestWorld::CreateInventory(const int32 Rows, const int32 Columns, const float WeightCapacity, const bool bChunkedStorage/* = false*/) const
+{
+	USIInventoryComponent* Inventory = NewObject<USIInventoryComponent>(Owner);
+	Inventory->InitializeGrid(Rows, Columns, WeightCapacity, bChunkedStorage);
+	Inventory->RegisterComponent();
+
+	return Inventory;
+}
+
+USIItem* SITests::FTestWorld::MakeItem(TSubclassOf<USIItem> ItemClass, const int32 Quantity/* = 1*/) const
+{
+	USIItem* Item = NewObject<USIItem>(Owner, ItemClass);
+	Item->SetQuantity(Quantity);
+
+	return Item;
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/SIContainerItem.h"
+#include "Items/SIItem.h"
+#include "UObject/StrongObjectPtr.h"
+#include "SITestFixtures.generated.h"
+
+/**Items the tests fill inventories with, one class per size since the size comes from the class default definition*/
+UCLASS(NotBlueprintable, HideDropdown)
+class USITestItem1x1 : public USIItem
+{
+	GENERATED_BODY()
+};
+
+UCLASS(NotBlueprintable, HideDropdown)
+class USITestItem1x2 : public USIItem
+{
+	GENERATED_BODY()
+};
+
+UCLASS(NotBlueprintable, HideDropdown)
+class USITestItem2x2 : public USIItem
+{
+	GENERATED_BODY()
+};
+
+UCLASS(NotBlueprintable, HideDropdown)
+class USITestItem2x3 : public USIItem
+{
+	GENERATED_BODY()
+};
+
+UCLASS(NotBlueprintable, HideDropdown)
+class USITestItem3x3 : public USIItem
+{
+	GENERATED_BODY()
+};
+
+UCLASS(NotBlueprintable, HideDropdown)
+class USITestContainerItem : public USIContainerItem
+{
+	GENERATED_BODY()
+};
+
+namespace SITests
+{
+	/**A bare game world with an actor that has authority and has begun play, which is all inventories need*/
+	struct FTestWorld
+	{
+		FTestWorld();
+		~FTestWorld();
+
+		//Gives the item class a transient definition for this test. The one it had is put back when the world goes away
+		void SetItemDefinition(UClass* ItemClass, const FIntPoint Dimensions, const float Weight, const int32 MaxStackSize = 1);
+
+		class USIInventoryComponent* CreateInventory(const int32 Rows, const int32 Columns, const float WeightCapacity, const bool bChunkedStorage = false) const;
+
+		USIItem* MakeItem(TSubclassOf<USIItem> ItemClass, const int32 Quantity = 1) const;
+
+		UWorld* World = nullptr;
+		AActor* Owner = nullptr;
+
+	private:
+
+		//What the class default objects had before this test, kept alive while they are swapped out
+		TMap<UClass*, TStrongObjectPtr<USIItemDefinition>> OriginalDefinitions;
+	};
+}